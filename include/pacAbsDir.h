@@ -2,10 +2,14 @@
 #define PACABSDIR_H
 #include "pacConsolePreRequisite.h"
 #include "pacSingleton.h"
+#include "pacSlabPool.h"
+#include <unordered_map>
+#include <unordered_set>
 
 namespace pac {
 
 typedef std::vector<AbsDir*> AbsDirs;
+typedef std::unordered_set<AbsDir*> AbsDirSet;
 
 /**
  * Abstract directory. Used to get set parameter of what every you want.
@@ -15,6 +19,28 @@ public:
   AbsDir(const std::string& name, StringInterface* si = 0);
   virtual ~AbsDir();
 
+  /**
+   * Plain dirs come from a slab pool, so creating and destroying lots of
+   * temp dirs doesn't hit the heap for the dir itself. Derived dirs of
+   * different size fall back to global new.
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* p, size_t size);
+
+  /**
+   * Approximate memory used by this dir, including heap memory of it's name,
+   * path and child containers, excluding string interface.
+   * @param recursive : include descendants
+   * @return : bytes
+   */
+  size_t getMemoryUsage(bool recursive = false) const;
+
+  /**
+   * Pool of plain dirs, it's never destroyed, dirs might outlive static
+   * objects.
+   */
+  static SlabPool& getPool();
+
   /**
    * Get parameter value.
    * @param name : parameter name
@@ -30,10 +56,10 @@ public:
   const std::string& getValueArgHandler(const std::string& name);
 
   /**
-   * Get vector of parameter names
+   * Get vector of parameter names, it's a view, don't keep it.
    * @return : vector of parameter names
    */
-  StringVector getParameters() const;
+  const StringVector& getParameters() const;
 
   /**
    * Set parameter value. This is only used for the most simple case.
@@ -68,10 +94,11 @@ public:
       const std::string& name, StringInterface* si, bool temp = true);
 
   /**
-   * Get full path until root
+   * Get full path until root. It's cached, refreshed only when this dir or
+   * one of it's ancestors is reparented or renamed.
    * @return : full path
    */
-  std::string getFullPath();
+  const std::string& getFullPath() const { return mFullPath; }
 
   /**
    * Throw if i overflow.
@@ -81,13 +108,41 @@ public:
   AbsDir* getChildAt(size_t i);
 
   /**
-   * Return 0 if not found.
+   * Throw if not found.
    * @param name : child dir name
-   * @return : 0 or child dir
+   * @return : child dir
    */
   AbsDir* getChildByName(const std::string& name);
 
-  bool hasChild(const std::string& name);
+  /**
+   * Return 0 if not found. If several children share the same name, the 1st
+   * added one is returned.
+   * @param name : child dir name
+   * @return : 0 or child dir
+   */
+  virtual AbsDir* findChild(const std::string& name);
+
+  virtual bool hasChild(const std::string& name);
+
+  /**
+   * Get names of children start with prefix, in name order. Unlike
+   * findChildrenByPrefix, no child is materialized for this.
+   * @param prefix : name prefix, blank for all children
+   * @param names : matched names will be appended to it
+   */
+  virtual void getChildNames(const std::string& prefix, StringVector& names);
+
+  /**
+   * Get children whose name start with prefix, in name order.
+   * @param prefix : name prefix, blank for all children
+   * @param dirs : matched children will be appended to it
+   */
+  void findChildrenByPrefix(const std::string& prefix, AbsDirs& dirs);
+
+  /**
+   * Children sorted by name, rebuilt after children change.
+   */
+  const AbsDirs& getSortedChildren();
 
   size_t getNumChildren() { return mChildren.size(); }
 
@@ -110,7 +165,12 @@ public:
   void removeChild(AbsDir* dir);
 
   /**
-   * serialize dir content to output stream
+   * serialize dir content to output stream as text, dir name in a line,
+   * followed by a "name value" line for each parameter, indented 1 level
+   * deeper. Use Snapshot if you need to load it back. Subtree is split into
+   * chunks of dirs in pre order, chunks are serialized by worker threads into
+   * their own buffers, then written in order by a single write, the output is
+   * the same as sequential serialization.
    * @param os : targte output stream
    * @param recursive : recursive or not
    * @lvl : current recursive level, each level taks 2 spaces
@@ -118,16 +178,28 @@ public:
   virtual void serialize(
       std::ostream& os, bool recursive = true, size_t lvl = 0);
 
+  /**
+   * Collect this dir and all materialized descendants in pre order.
+   * @param dirs : dirs will be appended to it
+   * @param levels : if not 0, depth of each dir below this one is appended
+   * to it
+   */
+  void collectSubtree(AbsDirs& dirs, SizetVector* levels = 0);
+
+  /**
+   * Destroy all temp dirs in this subtree, temp children of each dir are
+   * detached in one pass.
+   */
   virtual void cleanTempDirs();
 
   AbsDirs::iterator beginChildIter();
   AbsDirs::iterator endChildIter();
 
   const std::string& getName() const { return mName; }
-  void setName(const std::string& v) { mName = v; }
+  void setName(const std::string& v);
 
   AbsDir* getParent() const { return mParent; }
-  void setParent(AbsDir* v) { mParent = v; }
+  void setParent(AbsDir* v);
 
   StringInterface* getStringInterface() const { return mStringInterface; }
   void setStringInterface(StringInterface* v) ;
@@ -135,12 +207,133 @@ public:
   bool getTemp() const { return mTemp; }
   void setTemp(bool v) { mTemp = v; }
 
+  /**
+   * Called by string interface of this dir after it's parameter changed,
+   * watchers of the parameter are notified.
+   * @param name : parameter name
+   * @param generation : change generation of the change
+   */
+  void markChanged(const std::string& name, size_t generation);
+
+  /**
+   * @return : change generation of last parameter change, 0 if never changed
+   */
+  size_t getChangeGeneration() const { return mChangeGeneration; }
+
+  /**
+   * Dirs whose parameters changed at least once, in no particular order.
+   */
+  static const AbsDirSet& getChangedDirs() { return msChangedDirs; }
+
+  /**
+   * Generation of dir tree structure, it's bumped whenever a dir is added,
+   * removed, renamed or destroyed.
+   */
+  static size_t getGeneration() { return msGeneration; }
+
+  /**
+   * Same as findChild, but never materialize child of VirtualDir.
+   * @param name : child dir name
+   * @return : 0 or child dir
+   */
+  AbsDir* findIndexedChild(const std::string& name);
+
 protected:
+  void indexChild(AbsDir* dir);
+  void unindexChild(AbsDir* dir);
+
+  // rebuild full path of this dir and all descendants
+  void updateFullPath();
+
+  // serialize name and parameters of this dir only
+  void serializeSelf(std::ostream& os, size_t lvl);
+
+  // delete detached children, no fix up of this dir
+  void destroyChildren(const AbsDirs& dirs);
+
+protected:
+  // index key points to name of child itself, names are not copied
+  struct NameHash {
+    size_t operator()(const std::string* s) const {
+      return std::hash<std::string>()(*s);
+    }
+  };
+  struct NameEqual {
+    bool operator()(const std::string* lhs, const std::string* rhs) const {
+      return *lhs == *rhs;
+    }
+  };
+  // index nodes come from pool, child vectors are arrays of varying size,
+  // they stay in global heap
+  typedef std::unordered_map<const std::string*, AbsDir*, NameHash, NameEqual,
+      SlabAllocator<std::pair<const std::string* const, AbsDir*>>>
+      ChildIndex;
+
   bool mTemp;
+  bool mSortedDirty;
   AbsDir* mParent;
   StringInterface* mStringInterface;
   std::string mName;
-  AbsDirs mChildren;
+  std::string mFullPath;
+  AbsDirs mChildren;  // in add order
+  AbsDirs mSortedChildren;
+  ChildIndex mChildIndex;  // name to 1st child of that name
+  size_t mChangeGeneration;
+  static size_t msGeneration;
+  static AbsDirSet msChangedDirs;
+};
+
+/**
+ * Source of children of a VirtualDir, e.g. objects of a scene manager.
+ */
+class ChildProvider {
+public:
+  virtual ~ChildProvider() {}
+
+  /**
+   * Append names of all children, order doesn't matter.
+   * @param names : names will be appended to it
+   */
+  virtual void getChildNames(StringVector& names) = 0;
+
+  /**
+   * Check existence of child without creating it's string interface.
+   */
+  virtual bool hasChild(const std::string& name);
+
+  /**
+   * Create string interface for child.
+   * @param name : child name
+   * @return : 0 if there is no such child
+   */
+  virtual StringInterface* createStringInterface(const std::string& name) = 0;
+};
+
+/**
+ * Dir whose children are enumerated on demand from a provider. A child dir
+ * is materialized as temp dir only when it's looked up, i.e. cd into it or
+ * access it's parameters, so ctd drops it again. Listing and completion
+ * only read names from provider.
+ */
+class VirtualDir : public AbsDir {
+public:
+  /**
+   * @param name : dir name
+   * @param provider : child provider, it will be deleted with this dir
+   * @param si : string interface of this dir
+   */
+  VirtualDir(
+      const std::string& name, ChildProvider* provider, StringInterface* si = 0);
+  ~VirtualDir();
+
+  virtual AbsDir* findChild(const std::string& name);
+  virtual bool hasChild(const std::string& name);
+  virtual void getChildNames(const std::string& prefix, StringVector& names);
+
+  ChildProvider* getProvider() const { return mProvider; }
+
+private:
+  ChildProvider* mProvider;
 };
 
 class AbsDirUtil {
@@ -156,7 +349,40 @@ public:
    */
   static AbsDir* findPath(const std::string& path, AbsDir* curDir = 0);
 
+  /**
+   * Find all dirs matched by path pattern. Pattern can be relative or
+   * absolute, each path component can contain simple '*' wildcards.
+   * @param pattern : path pattern
+   * @param curDir : current dir, you can ignore this if you use absolute path
+   * @param dirs : matched dirs will be appended to it
+   */
+  static void findPathPattern(
+      const std::string& pattern, AbsDir* curDir, AbsDirs& dirs);
+
+  /**
+   * Find all children of curDir whose names are matched by regex.
+   * @param regex : regular expression
+   * @param curDir : parent dir
+   * @param dirs : matched dirs will be appended to it
+   */
+  static void findChildRegex(
+      const std::string& regex, AbsDir* curDir, AbsDirs& dirs);
+
 private:
+  /**
+   * (base dir, path), base dir is 0 for absolute path
+   */
+  typedef std::pair<AbsDir*, std::string> PathKey;
+  struct PathKeyHash {
+    size_t operator()(const PathKey& key) const;
+  };
+  typedef std::unordered_map<PathKey, AbsDir*, PathKeyHash> PathCache;
+
+  // resolved paths, valid only for msCacheGeneration. Misses are not cached,
+  // children of VirtualDir can appear without bumping generation.
+  static PathCache msPathCache;
+  static size_t msCacheGeneration;
+
   /**
    * find dir by absolute path
    * @param path : absolute path
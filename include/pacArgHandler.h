@@ -113,6 +113,11 @@ public:
 
   virtual ~ArgHandler() {}
 
+  /**
+   * Number of arg handlers ever created, used by stats to count allocations.
+   */
+  static size_t getNumCreated() { return msNumCreated; }
+
   /**
    * prompt, complete for current typing.
    * @param s : current typing word
@@ -226,6 +231,9 @@ protected:
   std::string mName;
   std::string mValue;
   StringVector mPromptBuffer;
+
+private:
+  static size_t msNumCreated;
 };
 
 /**
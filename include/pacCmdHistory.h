@@ -2,6 +2,17 @@
 #define PACROLLSTACK_H 
 
 #include "pacConsolePreRequisite.h"
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+
+namespace boost
+{
+namespace interprocess
+{
+class mapped_region;
+}
+}
 
 namespace pac
 {
@@ -17,6 +28,7 @@ public:
 	 * @param wrapSearch : wrap search at start and end
 	 */
 	CmdHistory(size_t size = 100, bool rollOver = false);
+	~CmdHistory();
 
 	/**
 	 * push cmdLine into history, it will be trimmed first. If cmdLine is the
@@ -40,6 +52,45 @@ public:
 
 	size_t size(){ return mStack.size(); }
 
+	/**
+	 * Load history file and append later pushes to it. The file is memory
+	 * mapped, only the last size() lines are read here, search index is built
+	 * at the 1st search, so load time doesn't depend on file size.
+	 * @param path : history file, it will be created if it doesn't exist
+	 */
+	void load(const std::string& path);
+
+	/**
+	 * Search command lines, most recent first, duplicated lines are returned
+	 * only once.
+	 * @param pattern : substring or prefix
+	 * @param prefix : match prefix only
+	 * @param limit : max number of results
+	 * @return : matched command lines
+	 */
+	StringVector search(const std::string& pattern, bool prefix = false,
+			size_t limit = -1);
+
+	/**
+	 * Ctrl-R style reverse search.
+	 * @param pattern : substring or prefix
+	 * @param skip : number of more recent matches to skip
+	 * @param prefix : match prefix only
+	 * @return : matched command line or blank
+	 */
+	std::string reverseSearch(const std::string& pattern, size_t skip = 0,
+			bool prefix = false);
+
+	/**
+	 * @return : number of pushed and loaded command lines
+	 */
+	size_t getNumEntries();
+
+	/**
+	 * @return : number of distinct command lines
+	 */
+	size_t getNumUniqueEntries();
+
 private:
 	//this must be called every time you push an item 
 	void resetRolling();
@@ -56,6 +107,41 @@ private:
 	 */
 	size_t getPrevRollingIndex(size_t i);
 
+	// push into rolling stack only, return false if it's the same as top
+	bool pushRolling(const std::string& l);
+
+	/**
+	 * Text of a command line, either in mapped file or in mPushed, never
+	 * copied.
+	 */
+	struct Entry
+	{
+		const char* data;
+		size_t size;
+		bool operator==(const Entry& rhs) const;
+	};
+
+	struct EntryHash
+	{
+		size_t operator()(const Entry& e) const;
+	};
+
+	struct Unique
+	{
+		Entry text;
+		size_t lastSeq;  // sequence of the most recent occurrence
+	};
+
+	typedef std::vector<Entry> Entries;
+	typedef std::unordered_map<Entry, size_t, EntryHash> UniqueMap;
+	typedef std::unordered_map<unsigned int, SizetVector> TrigramMap;
+
+	// index all lines in mapped file and lines pushed before it
+	void buildIndex();
+	void indexEntry(const Entry& e);
+	bool matches(const Entry& e, const std::string& pattern, bool prefix);
+	static unsigned int getTrigram(const char* s);
+
 private:
 
 	bool mRollOver; 	//if set to true, when touch bottom, return first, vice versa
@@ -63,6 +149,16 @@ private:
 	size_t mTopIndex;  	//current top index
 	StringVector mStack;
 	static std::string msBlank;
+
+	bool mIndexed;
+	boost::interprocess::mapped_region* mRegion;
+	std::ofstream mFile;
+	std::deque<std::string> mPushed;  // deque never moves it's elements
+	Entries mUnindexed;  // pushed before index is built
+	std::vector<Unique> mUniques;
+	SizetVector mSequence;  // unique id of every entry, in push order
+	UniqueMap mUniqueMap;  // text to unique id
+	TrigramMap mTrigrams;  // trigram to unique ids, ascending
 };
 
 
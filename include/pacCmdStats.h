@@ -0,0 +1,208 @@
+#ifndef PACCMDSTATS_H
+#define PACCMDSTATS_H
+
+#include "pacStringInterface.h"
+#include <chrono>
+
+namespace pac {
+
+/**
+ * Phases of command line processing.
+ */
+enum CmdPhase {
+  CP_LEX,       // split command name, args and options
+  CP_CLONE,     // clone command from prototype
+  CP_VALIDATE,  // validate args by arg handler
+  CP_EXECUTE,   // doExecute
+  CP_FORMAT,    // apply console pattern to buffered output
+  CP_PROMPT,    // whole prompt
+  CP_MAX
+};
+
+/**
+ * Latency histogram in nanoseconds. Samples are counted in log2 buckets, 4
+ * buckets per octave, so percentile is accurate to about 19%.
+ */
+class _PacExport LatencyHistogram {
+public:
+  LatencyHistogram() { reset(); }
+
+  void add(unsigned long long ns);
+  void reset();
+
+  /**
+   * Get approximate percentile.
+   * @param p : percentile in [0, 1]
+   * @return : upper bound of bucket contains p, clamped to max
+   */
+  unsigned long long getPercentile(double p) const;
+
+  /**
+   * @return : "count p50 p99 max", time in microseconds
+   */
+  std::string toString() const;
+
+  size_t getCount() const { return mCount; }
+  unsigned long long getMax() const { return mMax; }
+
+private:
+  enum { NUM_BUCKETS = 160 };  // 40 octaves, about 18 minutes
+  size_t mCount;
+  unsigned long long mMax;
+  size_t mBuckets[NUM_BUCKETS];
+};
+
+/**
+ * Stats of a single command, exposed as readonly params of /stats/<cmd>.
+ */
+class _PacExport CmdStatsRecord : public StringInterface {
+public:
+  CmdStatsRecord();
+
+  void reset();
+
+  LatencyHistogram& getHistogram(CmdPhase phase) { return mPhases[phase]; }
+  const LatencyHistogram& getHistogram(CmdPhase phase) const {
+    return mPhases[phase];
+  }
+
+  void addBranch(const std::string& branch) { ++mBranches[branch]; }
+  /**
+   * @return : "branch:count ..."
+   */
+  std::string getBranches() const;
+
+  /**
+   * arg handlers created during execute, it's the bulk of allocations.
+   */
+  void addNumHandlers(size_t n) { mNumHandlers.add(n); }
+  const LatencyHistogram& getNumHandlers() const { return mNumHandlers; }
+
+  struct _PacExport Phase : public ReadonlyParamCmd {
+    Phase(CmdPhase _phase) : phase(_phase) {}
+    virtual std::string doGet(const void* target) const;
+    CmdPhase phase;
+  };
+
+  struct _PacExport Branches : public ReadonlyParamCmd {
+    virtual std::string doGet(const void* target) const;
+  };
+
+  struct _PacExport NumHandlers : public ReadonlyParamCmd {
+    virtual std::string doGet(const void* target) const;
+  };
+
+  static Phase msLex, msClone, msValidate, msExecute, msFormat, msPrompt;
+  static Branches msBranches;
+  static NumHandlers msNumHandlers;
+
+protected:
+  void initParams();
+
+private:
+  LatencyHistogram mPhases[CP_MAX];
+  // handler count is not latency, but the same histogram works
+  LatencyHistogram mNumHandlers;
+  std::map<std::string, size_t> mBranches;
+};
+
+/**
+ * Per command stats. It's string interface of /stats, each command gets
+ * its child dir /stats/<cmd> the first time it's recorded. Recording is
+ * skipped if it's disabled.
+ */
+class _PacExport CmdStats : public StringInterface {
+public:
+  CmdStats();
+  ~CmdStats();
+
+  static bool getEnabled() { return msEnabled; }
+  static void setEnabled(bool v) { msEnabled = v; }
+
+  /**
+   * Reset all records. Dirs of records are kept.
+   */
+  void reset();
+
+  /**
+   * Get record of cmd, create it if it doesn't exist.
+   * @param cmd : command name
+   * @return : command record
+   */
+  CmdStatsRecord* getRecord(const std::string& cmd);
+
+  /**
+   * @param cmd : command name, ignored if empty
+   */
+  void record(const std::string& cmd, CmdPhase phase, unsigned long long ns);
+
+  AbsDir* getDir() const { return mDir; }
+  void setDir(AbsDir* v) { mDir = v; }
+
+  /**
+   * Command currently being executed or prompted, used to attribute phases
+   * out of command such as format.
+   */
+  const std::string& getCurrentCmd() const { return mCurrentCmd; }
+  void setCurrentCmd(const std::string& v) { mCurrentCmd = v; }
+
+  struct _PacExport Enabled : public ParamCmd {
+    Enabled() : ParamCmd("bool") {}
+    virtual std::string doGet(const void* target) const;
+    virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
+  };
+
+  /**
+   * set reset true to reset all records
+   */
+  struct _PacExport Reset : public ParamCmd {
+    Reset() : ParamCmd("bool") {}
+    virtual std::string doGet(const void* target) const;
+    virtual void doSet(void* target, ArgHandler* handler);
+  };
+
+  static Enabled msEnabledCmd;
+  static Reset msReset;
+
+protected:
+  void initParams();
+
+private:
+  typedef std::map<std::string, CmdStatsRecord*> RecordMap;
+  static bool msEnabled;
+  AbsDir* mDir;
+  RecordMap mRecords;
+  std::string mCurrentCmd;
+};
+
+/**
+ * Scoped timer of a phase. It does nothing if stats is disabled.
+ */
+class _PacExport CmdStatsTimer {
+public:
+  CmdStatsTimer(CmdPhase phase, const std::string& cmd = "");
+  ~CmdStatsTimer() { stop(); }
+
+  /**
+   * Record elapsed time, it's no-op after the 1st call.
+   */
+  void stop();
+
+  /**
+   * Change command name, used when command name is unknown at start.
+   */
+  void setCmd(const std::string& v) {
+    if (mRunning) mCmd = v;
+  }
+
+private:
+  bool mRunning;
+  CmdPhase mPhase;
+  std::string mCmd;
+  std::chrono::steady_clock::time_point mStart;
+};
+}
+
+#endif /* PACCMDSTATS_H */
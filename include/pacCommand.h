@@ -9,7 +9,7 @@ class Command {
 public:
   friend class CommandLib;
   /**
-   * ctor.
+   * ctor. Arg handler is not created until init.
    * @param name : ctor
    * @param ahName : handler name, don't set this if you need to build specific
    * handler for your command, override buildArgHandler instead.
@@ -52,6 +52,11 @@ public:
 
   ArgHandler* getArgHandler() const;
 
+  /**
+   * @return : true if arg handler is created
+   */
+  bool isInitialized() const { return mArgHandler != 0; }
+
   const std::string& getOptions() const { return mOptions; }
   void setOptions(const std::string& v) { mOptions = v; }
   const std::string& getArgs() const { return mArgs; }
@@ -83,14 +88,15 @@ protected:
 
 private:
   /**
-   * Init cmd, build arghandler. Should be called by command lib when registered
-   * at cmd lib
+   * Init cmd, build arghandler. It's called by command lib when the command
+   * is created for the 1st time.
    * @return : this
    */
   Command* init();
 
 protected:
   std::string mName;
+  std::string mAhName;
   std::string mOptions;
   std::string mArgs;
   ArgHandler* mArgHandler;
@@ -102,19 +108,27 @@ public:
 
   ~CommandLib();
   /**
-   * Create command by command name
+   * Create command by command name. Arg handler of command prototype is built
+   * here if it's the 1st time cmdName is created.
    * @param cmdName : command name
    * @return : newly created command or 0
    */
   Command* createCommand(const std::string& cmdName);
 
   /**
-   * Register new command and it's argument handler.
+   * Register new command. Only name is registered, argument handler is built
+   * at the 1st createCommand.
    * @remark : don't release prototype by yourself
    * @param cmdProto : command prototype,
    */
   void registerCommand(Command* cmdProto);
 
+  /**
+   * Unregister and delete command prototype.
+   * @param cmdName : command name
+   */
+  void unregisterCommand(const std::string& cmdName);
+
   /**
    * init , register intrinsic commands.
    */
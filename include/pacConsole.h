@@ -3,6 +3,7 @@
 
 #include "pacSingleton.h"
 #include "pacStringInterface.h"
+#include "pacOutputSink.h"
 
 namespace pac {
 
@@ -13,6 +14,15 @@ class Console : public Singleton<Console>, public StringInterface {
 public:
   friend class RaiiConsoleBuffer;
 
+  /**
+   * How buffered output reaches ui.
+   */
+  enum StreamMode {
+    SM_BUFFER,        // keep everything until endBuffer, aligned as a whole
+    SM_PAGE,          // flush every page size items, page aligned alone
+    SM_SINGLE_COLUMN  // flush every item as a single line
+  };
+
   Console(ConsoleUI* ui);
   virtual ~Console();
 
@@ -40,7 +50,55 @@ public:
    */
   Console& output(const std::string& s, int type = 1);
 
+  /**
+   * Output fragments as a single item, e.g. output({name, " : ", value}).
+   * Fragments are passed to ui and sinks as they are, nothing is concatenated
+   * unless it's buffered.
+   * @param frags : output fragments
+   * @param type : 1 stdout, 2 stderr
+   * @return : Console&
+   */
+  Console& output(Fragments frags, int type = 1);
+
   Console& outputLine(const std::string& s, int type = 1);
+  Console& outputLine(Fragments frags, int type = 1);
+
+  /**
+   * Output an item made of named fields, e.g. outputRecord({{"name", n},
+   * {"value", v}}). In text mode values are joined by " : " as a single item
+   * of buffer. In json mode it's output as a json object line immediately,
+   * buffer and pattern are skipped. Empty record outputs nothing.
+   * @param fields : record fields
+   * @return : Console&
+   */
+  Console& outputRecord(Fields fields);
+
+  /**
+   * Output records as json lines. Commands also turn it on with -j option.
+   */
+  bool getJsonOutput() const { return mJsonOutput; }
+  void setJsonOutput(bool v) { mJsonOutput = v; }
+
+  /**
+   * Add sink after ui, console doesn't own it, remove it before it's deleted.
+   * @param sink : output sink
+   */
+  void addSink(OutputSink* sink);
+  void removeSink(OutputSink* sink);
+
+  /**
+   * Output during execute and prompt is handed to ui in a single flush at the
+   * end, call this in long running commands to show output so far. It's also
+   * called at every page of SM_PAGE, and ui flushes by itself once batch
+   * reaches ConsoleUI::getMaxBatchSize.
+   */
+  void flushOutput();
+
+  /**
+   * Batch ui output until the outermost endBatch, use RaiiConsoleBatch.
+   */
+  void beginBatch();
+  void endBatch();
 
   /**
    * Complete current typing.
@@ -67,6 +125,64 @@ public:
    * flash buffer
    */
   void endBuffer();
+  bool isBuffering() const { return mIsBuffering != 0; }
+
+  /**
+   * Stop current buffered output, items output after this are dropped until
+   * endBuffer. Producers of long listings should check isOutputCancelled and
+   * stop early.
+   */
+  void cancelOutput();
+  bool isOutputCancelled() const { return mOutputCancelled; }
+
+  /**
+   * SM_BUFFER by default, so a listing is sorted and aligned as a whole. Use
+   * SM_PAGE or SM_SINGLE_COLUMN for huge listings.
+   */
+  StreamMode getStreamMode() const { return mStreamMode; }
+  void setStreamMode(StreamMode v) { mStreamMode = v; }
+
+  /**
+   * Number of items in a page of SM_PAGE, it's also the max number of items
+   * kept in buffer.
+   */
+  size_t getPageSize() const { return mPageSize; }
+  void setPageSize(size_t v);
+
+  /**
+   * Max number of items of a buffered output, output is cancelled once it's
+   * reached. 0 means unlimited.
+   */
+  size_t getOutputLimit() const { return mOutputLimit; }
+  void setOutputLimit(size_t v) { mOutputLimit = v; }
+
+  /**
+   * streamMode : buffer, page or singleColumn
+   */
+  class _PacExport Stream : public ParamCmd {
+  public:
+    Stream() : ParamCmd("streamMode") {}
+    virtual std::string doGet(const void* target) const;
+    virtual void doSet(void* target, ArgHandler* handler);
+  };
+
+  class _PacExport PageSize : public ParamCmd {
+  public:
+    PageSize() : ParamCmd("uint") {}
+    virtual std::string doGet(const void* target) const;
+    virtual void doSet(void* target, ArgHandler* handler);
+  };
+
+  class _PacExport OutputLimit : public ParamCmd {
+  public:
+    OutputLimit() : ParamCmd("uint") {}
+    virtual std::string doGet(const void* target) const;
+    virtual void doSet(void* target, ArgHandler* handler);
+  };
+
+  static Stream msStreamCmd;
+  static PageSize msPageSizeCmd;
+  static OutputLimit msOutputLimitCmd;
 
   /**
    * Roll command history
@@ -74,6 +190,15 @@ public:
    */
   void rollCommand(bool backWard = true);
 
+  /**
+   * Ctrl-R style reverse search of command history, put matched command line
+   * to ui.
+   * @param pattern : substring of command line
+   * @param skip : number of more recent matches to skip
+   * @return : true if found
+   */
+  bool searchCommand(const std::string& pattern, size_t skip = 0);
+
   /**
    * must be called at dtor of dir. Set cwd to root if cwd is the same as dir
    * being destroied. Set alternate dir to 0 if it's the same as dir being
@@ -88,12 +213,14 @@ public:
   void cleanTempDirs();
 
   ConsoleUI* getUi() const { return mUi; }
-  void setUi(ConsoleUI* v) { mUi = v; }
+  void setUi(ConsoleUI* v);
 
   bool isActive();
   void setActive(bool b);
   void toggleActive();
   ConsolePattern* getPattern() const { return mPattern; }
+  CmdStats* getCmdStats() const { return mCmdStats; }
+  CmdHistory* getCmdHistory() const { return mCmdHistory; }
 
   void resize();
 
@@ -108,6 +235,7 @@ protected:
   virtual void initArghandler();
   // set up commands
   virtual void initCommand();
+  void initParams();
 
 private:
   /**
@@ -123,18 +251,67 @@ private:
    */
   void fakeOutputDirAndCmd(const std::string& cmdLine);
 
-  void appendBuffer(const std::string& v);
+  Console& output(const Fragment* beg, const Fragment* end, int type);
+
+  void appendBuffer(const Fragment* beg, const Fragment* end);
+
+  // write to ui and all sinks
+  void writeSinks(Fragments frags, int type);
+  void writeSinks(const Fragment* beg, const Fragment* end, int type);
 
-  void cleanTempDir(AbsDir* dir);
+  // apply pattern to buffer, output and clear it
+  void flushBuffer();
+
+  /**
+   * Count an item of buffered output, cancel output if limit is reached.
+   * @return : false if it's dropped
+   */
+  bool acceptItem();
 
 private:
   int mIsBuffering;
+  int mBatchDepth;
+  bool mJsonOutput;
+  bool mOutputCancelled;
+  StreamMode mStreamMode;
+  size_t mPageSize;
+  size_t mNumDropped;  // items dropped after cancelOutput
+  size_t mOutputLimit;
+  size_t mNumItems;  // items of current buffered output
 
   AbsDir* mDir, *mAlternateDir, *mRootDir;
   ConsoleUI* mUi;
   ConsolePattern* mPattern;
   CmdHistory* mCmdHistory;
-  StringVector mBuffer;
+  CmdStats* mCmdStats;
+  StringVector mBuffer;  // strings are reused, only 1st mNumBuffered are valid
+  size_t mNumBuffered;
+  std::string mLineBreak;
+  std::vector<OutputSink*> mSinks;
+  std::vector<Fragment> mLineFrags;  // fragments of outputLine
+  std::vector<Fragment> mRecordFrags;  // fragments of text record
+  std::string mJsonLine;  // reused json record
+};
+
+/**
+ * RAII of json output, restore previous json output at dtor.
+ */
+class RaiiConsoleJson {
+public:
+  RaiiConsoleJson(bool enable);
+  ~RaiiConsoleJson();
+
+private:
+  bool mPrevious;
+};
+
+/**
+ * RAII of console batch
+ */
+class RaiiConsoleBatch {
+public:
+  RaiiConsoleBatch();
+  ~RaiiConsoleBatch();
 };
 
 /**
@@ -25,6 +25,25 @@ public:
    */
   virtual std::string applyPattern(SVIter beg, SVIter end) = 0;
 
+  /**
+   * Apply pattern to one page of streamed output. Pages are laid out
+   * independently, later items will never change layout of previous page.
+   * @param beg : begin iter
+   * @param end : end iter
+   * @return : formated string
+   */
+  virtual std::string applyPage(SVIter beg, SVIter end) {
+    return applyPattern(beg, end);
+  }
+
+  /**
+   * Single column fallback of streamed output, item is formated as soon as
+   * it's output, nothing is kept.
+   * @param item : output item
+   * @return : formated string
+   */
+  virtual std::string applyLine(const std::string& item) { return item + "\n"; }
+
   size_t getTextWidth() const { return mTextWidth; }
   void setTextWidth( size_t v){mTextWidth = v;}
 
@@ -48,6 +67,7 @@ public:
   DefaultPattern(size_t textWidth, size_t spacing = 2);
 
   virtual std::string applyPattern(SVIter beg, SVIter end);
+  virtual std::string applyLine(const std::string& item);
 
 protected:
   /**
@@ -73,16 +93,41 @@ protected:
   SizetVector getCandidateNumColumns(
       size_t numItem, size_t minItemLen, size_t maxItemLen);
 
+  /**
+   * Range maximum over item lengths, built once per applyPattern, so width of
+   * a column can be queried in O(log(numItem)) instead of rescanning it.
+   */
+  class RangeMax {
+  public:
+    RangeMax(SVIter beg, SVIter end);
+    /**
+     * @param first : index of first item
+     * @param last : index of 1 past last item
+     * @return : max item length in [first, last)
+     */
+    size_t query(size_t first, size_t last) const;
+    size_t size() const { return mSize; }
+
+  private:
+    size_t mSize;
+    std::vector<unsigned int> mTree;  // iterative segment tree, leaves at mSize
+  };
+
   /**
    * Check if column number is valid. It's valid if total column width is
-   * smaller than line width;
-   * @param beg : begin iter
-   * @param end : end iter
+   * smaller than line width. Stop as soon as total column width overflows.
+   * @param rm : range maximum of item lengths
    * @param numCol : number of columns
    * @param{out} colWidthes : column width of each column
    * @return : true if it's valid, otherwise false;
    */
-  bool valid(SVIter beg, SVIter end, size_t numCol, SizetVector& colWidthes);
+  bool valid(const RangeMax& rm, size_t numCol, SizetVector& colWidthes);
+
+  /**
+   * Write items into a preallocated string, item sequence is vertical, output
+   * is horizental.
+   */
+  std::string layout(SVIter beg, SVIter end, const SizetVector& colWidthes);
 
 protected:
   size_t mSpacing;
@@ -55,6 +55,7 @@ typedef std::vector<std::string> StringVector;
 typedef StringVector::iterator SVIter;
 typedef StringVector::const_iterator SVCIter;
 typedef std::vector<int> IntVector;
+typedef std::vector<Real> RealVector;
 typedef std::vector<size_t> SizetVector;
 typedef std::vector<float> FloatVector;
 typedef std::set<std::string> StringSet;
@@ -65,13 +66,19 @@ namespace pac
 {
 	class AbsDir;
 	class ArgHandler;
+	class ChildProvider;
 	class CmdHistory;
+	class CmdStats;
 	class Command;
 	class Console;
 	class ConsolePattern;
 	class DefaultPattern;
 	class Logger;
 	class Node;
+	class OutputSink;
+	class ParamListener;
+	class ParamValue;
+	class SlabPool;
 	class StringInterface;
 	class TreeArgHandler;
 	class ConsoleUI;
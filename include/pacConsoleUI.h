@@ -1,21 +1,50 @@
 #ifndef PACUICONSOLE_H
 #define PACUICONSOLE_H
 #include "pacStringInterface.h"
+#include "pacOutputSink.h"
 
 namespace pac {
 
-class ConsoleUI : public StringInterface {
+class ConsoleUI : public StringInterface, public OutputSink {
 public:
   ConsoleUI();
-  ~ConsoleUI(){};
+  virtual ~ConsoleUI(){};
 
   /**
-   * Fake stdout and stderr. Wrap line automatically.
+   * Fake stdout and stderr. Wrap line automatically. Output is recorded in
+   * scrollback, front end only get appended text and number of evicted
+   * characters, it never needs to rebuild the whole output. Front end should
+   * implement appendOutput and evictOutput, an override of this must call it
+   * to keep scrollback.
    * @param output : outout content
    * @param type : 1 stdout, 2 stderr
    * @return : *this
    */
-  virtual void output(const std::string& output, int type = 1){};
+  virtual void output(const std::string& output, int type = 1);
+
+  /**
+   * Output fragments, they are gathered in a reused string.
+   */
+  virtual void write(const Fragment* beg, const Fragment* end, int type);
+
+  /**
+   * Hand over batched output to front end.
+   */
+  virtual void flush();
+
+  /**
+   * If batching, output is recorded in scrollback only, front end get it at
+   * flush, as a single append. Turning it off flushes.
+   */
+  bool getBatching() const { return mBatching; }
+  void setBatching(bool v);
+
+  /**
+   * Batched output is flushed once it reaches this many bytes, so a huge
+   * listing never piles up in batch.
+   */
+  size_t getMaxBatchSize() const { return mMaxBatchSize; }
+  void setMaxBatchSize(size_t v);
 
   /**
    * Fake stdout and stderr. Wrap line automatically.
@@ -50,17 +79,76 @@ public:
    */
   int getTextWidth() const ;
 
+  /**
+   * Max number of lines kept in scrollback, oldest lines will be evicted if
+   * it's exceeded.
+   */
+  size_t getMaxLines() const { return mMaxLines; }
+  void setMaxLines(size_t v);
+
+  size_t getNumLines() const { return mNumLines; }
+  /**
+   * @param i : line index, 0 is the oldest one
+   * @return : line with trailing line break, last line might has none
+   */
+  const std::string& getLine(size_t i) const;
+  /**
+   * @return : all lines in scrollback
+   */
+  std::string getScrollback() const;
+
   class Alpha : public ParamCmd {
   public:
     Alpha() : ParamCmd("npreal") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
+  };
+
+  class MaxLines : public ParamCmd {
+  public:
+    MaxLines() : ParamCmd("uint") {}
+    virtual std::string doGet(const void* target) const;
+    virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   static Alpha msAlpha;
+  static MaxLines msMaxLines;
 
 protected:
   void initParams();
+
+  /**
+   * Append text to output widget.
+   * @param text : output content
+   * @param type : 1 stdout, 2 stderr
+   */
+  virtual void appendOutput(const std::string& text, int type) {}
+
+  /**
+   * Remove oldest characters from output widget.
+   * @param numChars : number of characters(utf8 code points)
+   */
+  virtual void evictOutput(size_t numChars) {}
+
+private:
+  // push new line or append to last unfinished line, return evicted chars
+  size_t pushLine(const char* beg, const char* end);
+
+private:
+  std::string mPending;  // gathered fragments
+  bool mBatching;
+  int mBatchType;          // type of batched output
+  std::string mBatch;      // output not handed over to front end yet
+  size_t mNumBatchEvicted;  // chars evicted since last flush
+  size_t mMaxBatchSize;
+  StringVector mLines;  // scrollback ring, capacity is mMaxLines
+  size_t mFirstLine;    // index of oldest line in mLines
+  size_t mNumLines;
+  size_t mMaxLines;
 };
 }
 
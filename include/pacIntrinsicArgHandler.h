@@ -3,6 +3,7 @@
 
 #include "pacArgHandler.h"
 #include "pacConsole.h"
+#include "pacAbsDir.h"
 #include "pacStringUtil.h"
 #include "pacEnumUtil.h"
 
@@ -206,7 +207,9 @@ protected:
 };
 
 /**
- * param handler. "path"  can be followed with a "param" handler
+ * param handler. "path"  can be followed with a "param" handler. Parameters
+ * are looked up in string interface of dir, they are not copied. If it follows
+ * "glob" or "regex", parameters of all matched dirs are accepted.
  */
 class _PacExport ParamArgHandler : public StringArgHandler {
 public:
@@ -219,12 +222,17 @@ public:
 
   virtual void runtimeInit();
 
+  virtual void populatePromptBuffer(const std::string& s);
+
 protected:
   virtual void onLinked(Node* grandNode);
+  virtual bool doValidate(const std::string& s);
 
 private:
   AbsDir* mDir;  // cwd
   Node* mPathNode;
+  Node* mPatternNode;  // glob or regex
+  AbsDirs mPatternDirs;  // dirs matched by mPatternNode
 };
 
 /**
@@ -293,6 +301,36 @@ protected:
   };
 };
 
+/**
+ * glob, path pattern used to match multiple dirs. Each path component can
+ * contain simple '*' wildcards.
+ */
+class _PacExport GlobArgHandler : public ArgHandler {
+public:
+  GlobArgHandler() : ArgHandler("glob") { setPromptType(PT_PROMPTONLY); }
+  virtual ArgHandler* clone() { return new GlobArgHandler(*this); }
+
+  virtual void populatePromptBuffer(const std::string& s);
+
+protected:
+  virtual bool doValidate(const std::string& s) { return !s.empty(); };
+};
+
+/**
+ * raw, accept any non blank word. Used when real value handler can't be
+ * determined until execution, such as value of bulk set.
+ */
+class _PacExport RawArgHandler : public ArgHandler {
+public:
+  RawArgHandler() : ArgHandler("raw") { setPromptType(PT_PROMPTONLY); }
+  virtual ArgHandler* clone() { return new RawArgHandler(*this); }
+
+  virtual void populatePromptBuffer(const std::string& s);
+
+protected:
+  virtual bool doValidate(const std::string& s) { return !s.empty(); };
+};
+
 /*
  * readonly
  */
@@ -2,6 +2,8 @@
 #define PACINTRINSICCMD_H
 
 #include "pacCommand.h"
+#include "pacAbsDir.h"
+#include <boost/regex.hpp>
 
 namespace pac {
 
@@ -69,8 +71,13 @@ protected:
 };
 
 /**
- * set param value
- * set path param value
+ * set param value ("0")
+ * set path param value ("1")
+ * set ltl_glob glob param rawValue... ("2")
+ * set ltl_regex regex param rawValue... ("3")
+ *
+ * The last 2 forms set the same value to every matched dir, glob is a path
+ * pattern, regex is matched against names of children of current dir.
  */
 class _PacExport SetCmd : public Command {
 public:
@@ -84,6 +91,18 @@ public:
 protected:
   virtual bool doExecute();
   virtual bool buildArgHandler();
+
+private:
+  /**
+   * Set param of all dirs to value. Value is validated only once for each
+   * distinct value arg handler, a summary is output at the end.
+   * @param dirs : target dirs
+   * @param param : param name
+   * @param value : param value
+   * @return : true if all dirs succeeded
+   */
+  bool bulkSet(const AbsDirs& dirs, const std::string& param,
+      const std::string& value);
 };
 
 /**
@@ -119,9 +138,15 @@ private:
 
 /**
  * serialize dir to file, it's a recursive opration by default, use -R if you
- * don't want to block recursive
- * sz [-R] id ("0")
- * sz [-R] id path ("1")
+ * don't want to block recursive, use -b to write binary snapshot which can be
+ * loaded back by load.
+ * sz [-R] [-b] id ("0")
+ * sz [-R] [-b] id path ("1")
+ *
+ * write binary increment of parameters changed after binary snapshot base, it
+ * can be loaded after base, or merged into base by szmerge.
+ * sz id ltl_since base ("2")
+ * sz id path ltl_since base ("3")
  */
 class _PacExport SzCmd : public Command {
 public:
@@ -132,6 +157,123 @@ protected:
   virtual bool doExecute();
   virtual bool buildArgHandler();
 };
+
+/**
+ * load id ("0")
+ * load id path ("1")
+ *
+ * apply binary snapshot file id to current dir or path.
+ */
+class _PacExport LoadCmd : public Command {
+public:
+  LoadCmd();
+  virtual Command* clone() { return new LoadCmd(*this); }
+
+protected:
+  virtual bool doExecute();
+  virtual bool buildArgHandler();
+};
+
+/**
+ * szmerge id base increment+ ("0")
+ *
+ * overlay binary increments on binary snapshot base in order, write result to
+ * id.
+ */
+class _PacExport SzMergeCmd : public Command {
+public:
+  SzMergeCmd();
+  virtual Command* clone() { return new SzMergeCmd(*this); }
+
+protected:
+  virtual bool doExecute();
+  virtual bool buildArgHandler();
+};
+
+/**
+ * watch ("0")
+ * watch [-s] [-d] path param ("1")
+ *
+ * Print "path : param : value" whenever watched parameter is set, use -s to
+ * also catch changes made outside console at every ParamWatch::sample, use -d
+ * to stop watching. List watches if no argument is given.
+ */
+class _PacExport WatchCmd : public Command {
+public:
+  WatchCmd();
+  virtual Command* clone() { return new WatchCmd(*this); }
+
+  /**
+   * Listener shared by all watch commands.
+   */
+  static ParamListener* getListener();
+
+protected:
+  virtual bool doExecute();
+  virtual bool buildArgHandler();
+};
+
+/**
+ * find path ("0")
+ * find path ltl_name glob ("1")
+ * find path ltl_param param ("2")
+ * find path ltl_param param findOp operand+ ("3")
+ *
+ * Search subtree of path, output full path of every matched dir. Dirs are
+ * collected in calling thread, matching is split across worker threads for big
+ * subtree, results are output batch by batch in the same order as sequential
+ * search, i.e. pre order, children in name order. Records of -j keep that
+ * order, text output is sorted and aligned by console pattern as ls.
+ *
+ * findOp is one of == != < <= > >= ~. ~ matches value against regex, the
+ * others compare every real component of value with operand, which can be
+ * a single real or the same number of reals as value.
+ */
+class _PacExport FindCmd : public Command {
+public:
+  FindCmd();
+  virtual Command* clone() { return new FindCmd(*this); }
+
+protected:
+  virtual bool doExecute();
+  virtual bool buildArgHandler();
+
+private:
+  /**
+   * Dir to be matched. Unmaterialized child of VirtualDir only gets a
+   * temporary string interface during matching.
+   */
+  struct Item {
+    std::string path;
+    std::string name;
+    AbsDir* dir;       // 0 if unmaterialized
+    VirtualDir* vdir;  // parent of unmaterialized child
+  };
+  typedef std::vector<Item> Items;
+
+  // collect dir and all it's descendants in output order
+  void collect(AbsDir* dir, Items& items);
+
+  /**
+   * @param name : dir name
+   * @param si : string interface of dir, can be 0
+   * @param value : value of mParam
+   * @return : true if matched
+   */
+  bool match(const std::string& name, StringInterface* si,
+      std::string& value) const;
+
+  // compare value with mOperand by mOp
+  bool compare(const std::string& value) const;
+
+private:
+  std::string mBranch;
+  std::string mGlob;
+  std::string mParam;
+  std::string mOp;
+  std::string mOperand;
+  boost::regex mRegex;
+};
 };
 
 #endif /* PACINTRINSICCMD_H */
@@ -0,0 +1,129 @@
+#ifndef PACOUTPUTSINK_H
+#define PACOUTPUTSINK_H
+
+#include "pacConsolePreRequisite.h"
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace pac {
+
+/**
+ * Piece of output text. It doesn't own the text, it must not outlive the
+ * string it's created from, which is fine for a single output call.
+ */
+struct _PacExport Fragment {
+  Fragment(const std::string& s) : data(s.data()), size(s.size()) {}
+  Fragment(const char* s) : data(s), size(strlen(s)) {}
+  Fragment(const char* s, size_t n) : data(s), size(n) {}
+
+  const char* data;
+  size_t size;
+};
+
+typedef std::initializer_list<Fragment> Fragments;
+
+/**
+ * Named field of an output record.
+ */
+struct _PacExport Field {
+  const char* name;
+  Fragment value;
+};
+
+typedef std::initializer_list<Field> Fields;
+
+/**
+ * Consumer of console output. Console feeds every output to ui and a chain of
+ * sinks, fragments are handed over as they are, sinks should consume them
+ * without building intermediate strings.
+ */
+class _PacExport OutputSink {
+public:
+  virtual ~OutputSink() {}
+
+  /**
+   * Consume fragments of a single output.
+   * @param beg : first fragment
+   * @param end : 1 past last fragment
+   * @param type : 1 stdout, 2 stderr
+   */
+  virtual void write(const Fragment* beg, const Fragment* end, int type) = 0;
+
+  /**
+   * Make sure everything written so far has reached it's destination.
+   */
+  virtual void flush() {}
+};
+
+/**
+ * Tee output to file.
+ */
+class _PacExport FileSink : public OutputSink {
+public:
+  /**
+   * @param path : file path
+   * @param append : append to or truncate existing file
+   */
+  FileSink(const std::string& path, bool append = true);
+
+  virtual void write(const Fragment* beg, const Fragment* end, int type);
+  virtual void flush();
+
+private:
+  std::ofstream mFile;
+};
+
+/**
+ * Capture output in memory, mainly for test.
+ */
+class _PacExport CaptureSink : public OutputSink {
+public:
+  virtual void write(const Fragment* beg, const Fragment* end, int type);
+
+  const std::string& getCaptured() const { return mCaptured; }
+  void clear() { mCaptured.clear(); }
+
+private:
+  std::string mCaptured;
+};
+
+/**
+ * Log output in a background thread, one log record per line. Write only
+ * appends fragments to a queue, which is swapped with a back buffer by log
+ * thread, both buffers keep their capacity.
+ */
+class _PacExport AsyncLogSink : public OutputSink {
+public:
+  AsyncLogSink();
+  /**
+   * Log everything in queue, then stop log thread.
+   */
+  ~AsyncLogSink();
+
+  virtual void write(const Fragment* beg, const Fragment* end, int type);
+
+  /**
+   * Block until everything in queue is logged.
+   */
+  virtual void flush();
+
+private:
+  void run();
+  void logLines(const std::string& text);
+
+private:
+  bool mStop;
+  size_t mNumQueued;  // number of writes to queue
+  size_t mNumLogged;  // number of writes logged
+  std::string mQueue, mBack;
+  std::mutex mMutex;
+  std::condition_variable mQueueCond;   // queue is not empty or stop
+  std::condition_variable mLoggedCond;  // queue is logged
+  std::thread mThread;
+};
+}
+
+#endif /* PACOUTPUTSINK_H */
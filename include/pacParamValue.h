@@ -0,0 +1,86 @@
+#ifndef PACPARAMVALUE_H
+#define PACPARAMVALUE_H
+
+#include "pacConsolePreRequisite.h"
+
+namespace pac {
+
+/**
+ * Typed parameter value used by typed get and set of ParamCmd. It's a small
+ * tagged union, none of it's types allocates. Getters throw if value is of
+ * another type.
+ */
+class _PacExport ParamValue {
+public:
+  enum Type {
+    PVT_NONE,
+    PVT_BOOL,
+    PVT_INT,
+    PVT_REAL,
+    PVT_REALS,   // fixed size real array, vector, quaternion, colour
+    PVT_ENUM,    // enum value as int
+    PVT_OBJECT,  // object reference
+  };
+
+  enum { MAX_REALS = 4 };
+
+  ParamValue() : mType(PVT_NONE), mNumReals(0) {}
+
+  static ParamValue makeBool(bool v);
+  static ParamValue makeInt(int v);
+  static ParamValue makeReal(Real v);
+  /**
+   * @param v : reals
+   * @param n : number of reals, no more than MAX_REALS
+   */
+  static ParamValue makeReals(const Real* v, size_t n);
+  static ParamValue makeEnum(int v);
+  static ParamValue makeObject(void* v);
+
+  Type getType() const { return mType; }
+
+  bool getBool() const;
+  int getInt() const;
+  Real getReal() const;
+  const Real* getReals() const;
+  size_t getNumReals() const { return mNumReals; }
+  /**
+   * @param n : expected number of reals
+   */
+  const Real* getReals(size_t n) const;
+  /**
+   * Range checked getters, typed set calls them with bounds of the arg
+   * handler used by string set, so both paths accept the same values.
+   * Throw if value is out of [min, max].
+   */
+  int getInt(int min, int max) const;
+  Real getReal(Real min, Real max) const;
+  const Real* getReals(size_t n, Real min, Real max) const;
+  int getEnum() const;
+  void* getObject() const;
+  template <typename T>
+  T* getObject() const {
+    return static_cast<T*>(getObject());
+  }
+
+  bool operator==(const ParamValue& rhs) const;
+  bool operator!=(const ParamValue& rhs) const { return !(*this == rhs); }
+
+private:
+  void checkType(Type type) const;
+  template <typename T>
+  static void checkRange(T v, T min, T max);
+
+private:
+  Type mType;
+  size_t mNumReals;
+  union {
+    bool b;
+    int i;
+    Real reals[MAX_REALS];
+    void* object;
+  } mData;
+};
+}
+
+#endif /* PACPARAMVALUE_H */
@@ -0,0 +1,125 @@
+#ifndef PACPARAMWATCH_H
+#define PACPARAMWATCH_H
+
+#include "pacConsolePreRequisite.h"
+#include <unordered_map>
+
+namespace pac {
+
+/**
+ * Receiver of parameter changes.
+ */
+class _PacExport ParamListener {
+public:
+  virtual ~ParamListener() {}
+
+  /**
+   * Called after parameter of a watched dir changed. Don't delete listener
+   * in it.
+   * @param dir : watched dir
+   * @param name : parameter name
+   * @param value : new value
+   */
+  virtual void onParameterChanged(
+      AbsDir* dir, const std::string& name, const std::string& value) = 0;
+};
+
+/**
+ * Queue changes until owner drains them, e.g. once per frame. Successive
+ * changes of the same parameter are kept, events are in change order.
+ */
+class _PacExport QueuedParamListener : public ParamListener {
+public:
+  struct Event {
+    AbsDir* dir;
+    std::string name;
+    std::string value;
+  };
+  typedef std::vector<Event> Events;
+
+  virtual void onParameterChanged(
+      AbsDir* dir, const std::string& name, const std::string& value);
+
+  /**
+   * Move queued events to events, events is cleared first.
+   */
+  void drain(Events& events);
+
+  size_t getNumQueued() const { return mEvents.size(); }
+
+private:
+  Events mEvents;
+};
+
+/**
+ * Registry of watched (dir, parameter). Changes made by setParameter are
+ * pushed to listeners right after the set. Values changed behind the
+ * console's back can only be found by comparison, watches added with sampled
+ * are compared at every sample call, which is supposed to be called once per
+ * frame. If nothing is watched, set costs a single check.
+ *
+ * Watches die with their dir, temp dirs of VirtualDir are destroyed after
+ * every command, watch their owner instead.
+ */
+class _PacExport ParamWatch {
+private:
+  ParamWatch() {}
+
+public:
+  struct Watch {
+    std::string name;
+    ParamListener* listener;
+    bool sampled;
+    std::string lastValue;  // only used by sampled watch
+  };
+  typedef std::vector<Watch> Watches;
+  typedef std::unordered_map<AbsDir*, Watches> WatchMap;
+
+  /**
+   * Watch parameter of dir, it's a no-op if it's already watched by
+   * listener.
+   * @param dir : target dir
+   * @param name : parameter name
+   * @param listener : receiver, not owned
+   * @param sampled : also compare value at every sample
+   */
+  static void add(AbsDir* dir, const std::string& name,
+      ParamListener* listener, bool sampled = false);
+
+  /**
+   * @return : false if it's not watched by listener
+   */
+  static bool remove(
+      AbsDir* dir, const std::string& name, ParamListener* listener);
+
+  /**
+   * Remove all watches of listener, call it before listener is destroyed.
+   */
+  static void removeListener(ParamListener* listener);
+
+  /**
+   * Remove all watches of dir, it's called when dir is destroyed.
+   */
+  static void removeDir(AbsDir* dir);
+
+  /**
+   * Notify listeners of dir param, it's called by dir after parameter set.
+   */
+  static void notify(AbsDir* dir, const std::string& name);
+
+  /**
+   * Compare values of sampled watches, notify listeners of changed ones.
+   * @return : number of changed watches
+   */
+  static size_t sample();
+
+  static bool hasWatches() { return !msWatches.empty(); }
+  static const WatchMap& getWatches() { return msWatches; }
+
+private:
+  static WatchMap msWatches;
+  static size_t msNumSampled;
+};
+}
+
+#endif /* PACPARAMWATCH_H */
@@ -0,0 +1,105 @@
+#ifndef PACSLABPOOL_H
+#define PACSLABPOOL_H
+
+#include "pacConsolePreRequisite.h"
+
+namespace pac {
+
+/**
+ * Fixed size block allocator. Blocks are carved from slabs of blocksPerSlab
+ * blocks, freed blocks are kept in a free list and reused first, slabs are
+ * only released when pool is destroyed. It's not thread safe.
+ */
+class _PacExport SlabPool {
+public:
+  /**
+   * @param blockSize : size of each block, it's rounded up to pointer
+   * alignment
+   * @param blocksPerSlab : number of blocks in each slab
+   */
+  SlabPool(size_t blockSize, size_t blocksPerSlab = 256);
+  ~SlabPool();
+
+  /**
+   * Allocate a block of getBlockSize bytes.
+   */
+  void* allocate();
+
+  /**
+   * Return block to free list.
+   * @param p : block allocated from this pool
+   */
+  void deallocate(void* p);
+
+  size_t getBlockSize() const { return mBlockSize; }
+  size_t getNumSlabs() const { return mSlabs.size(); }
+  size_t getNumAllocated() const { return mNumAllocated; }
+
+  /**
+   * @return : bytes of all slabs
+   */
+  size_t getCapacity() const { return mSlabs.size() * mSlabSize; }
+
+private:
+  void addSlab();
+
+private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  size_t mBlockSize;
+  size_t mBlocksPerSlab;
+  size_t mSlabSize;
+  size_t mNumAllocated;
+  FreeBlock* mFreeList;
+  std::vector<char*> mSlabs;
+};
+
+/**
+ * Allocator of node based containers. Single object allocations, i.e. nodes,
+ * come from a pool shared by all allocators of T, arrays such as bucket
+ * arrays fall back to global new. It's not thread safe.
+ */
+template <typename T>
+class SlabAllocator {
+public:
+  typedef T value_type;
+
+  SlabAllocator() {}
+  template <typename U>
+  SlabAllocator(const SlabAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    if (n == 1) return static_cast<T*>(getPool().allocate());
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (n == 1)
+      getPool().deallocate(p);
+    else
+      ::operator delete(p);
+  }
+
+  /**
+   * Pool of T, it's never destroyed, containers might outlive static objects.
+   */
+  static SlabPool& getPool() {
+    static SlabPool* pool = new SlabPool(sizeof(T), 256);
+    return *pool;
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const SlabAllocator<T>&, const SlabAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const SlabAllocator<T>&, const SlabAllocator<U>&) {
+  return false;
+}
+}
+
+#endif /* PACSLABPOOL_H */
@@ -0,0 +1,169 @@
+#ifndef PACSNAPSHOT_H
+#define PACSNAPSHOT_H
+
+#include "pacConsolePreRequisite.h"
+
+namespace pac {
+
+/**
+ * Binary snapshot of dir tree parameters.
+ *
+ * Layout, all integers are 4 bytes little endian, strings are length
+ * prefixed:
+ *   "PACS" version sessionLow sessionHigh generationLow generationHigh dir
+ *   dir : name numParams (paramName paramValue)* numChildren dir*
+ *
+ * Readonly parameters are not saved. Snapshot is applied back through
+ * setParameter, root record is applied to the target dir whatever it's name
+ * is, child records are matched by name.
+ *
+ * Generation is StringInterface::getChangeGeneration at the time of writing.
+ * It restarts with every process, so session identifies the process that
+ * wrote the snapshot, generations are only comparable within a session.
+ * An increment has the same layout, it contains only parameters changed after
+ * a base generation and the dirs leading to them, applying it or merging it
+ * into it's base gives the same result as a full snapshot.
+ */
+class _PacExport Snapshot {
+private:
+  Snapshot() {}
+
+public:
+  static const unsigned int version = 1;
+
+  /**
+   * Append snapshot of dir to buffer, header included. Records are written
+   * by worker threads into chunk buffers, output is the same as sequential
+   * write.
+   * @param dir : source dir
+   * @param buf : snapshot will be appended to it
+   * @param recursive : include descendants
+   */
+  static void write(AbsDir* dir, std::string& buf, bool recursive = true);
+
+  /**
+   * Append increment of dir to buffer, header included. Only dirs changed
+   * after baseGeneration are visited, cost is proportional to number of
+   * changes, not size of subtree.
+   * @param dir : source dir
+   * @param buf : increment will be appended to it
+   * @param baseGeneration : generation of base snapshot
+   */
+  static void writeIncrement(
+      AbsDir* dir, std::string& buf, size_t baseGeneration);
+
+  /**
+   * Write snapshot of dir to file in a single write.
+   * @param dir : source dir
+   * @param path : file path, it's truncated
+   * @param recursive : include descendants
+   */
+  static void save(AbsDir* dir, const std::string& path, bool recursive = true);
+
+  /**
+   * Write increment of dir to file in a single write.
+   * @param dir : source dir
+   * @param path : file path, it's truncated
+   * @param baseGeneration : generation of base snapshot
+   */
+  static void saveIncrement(
+      AbsDir* dir, const std::string& path, size_t baseGeneration);
+
+  /**
+   * Write increment of dir since base to file if base is written in this
+   * session, otherwise write full snapshot of dir.
+   * @param dir : source dir
+   * @param path : file path, it's truncated
+   * @param base : base snapshot data
+   * @return : true if increment is written
+   */
+  static bool saveSince(
+      AbsDir* dir, const std::string& path, const std::string& base);
+
+  /**
+   * @param data : snapshot data
+   * @param size : snapshot size
+   * @return : generation in snapshot header
+   */
+  static size_t getGeneration(const char* data, size_t size);
+
+  /**
+   * @param data : snapshot data
+   * @param size : snapshot size
+   * @return : session in snapshot header
+   */
+  static unsigned long long getSession(const char* data, size_t size);
+
+  /**
+   * @return : session of this process, it's random and never 0.
+   */
+  static unsigned long long getSessionId();
+
+  /**
+   * Overlay increments on base in order, parameters and children are matched
+   * by name, later ones win. Result has session and generation of the last
+   * one.
+   * @param snapshots : base followed by increments
+   * @param buf : merged snapshot will be appended to it
+   */
+  static void merge(const StringVector& snapshots, std::string& buf);
+
+  /**
+   * Read whole file into buffer.
+   * @param path : file path
+   * @return : file content
+   */
+  static std::string read(const std::string& path);
+
+  /**
+   * Apply snapshot to dir. Missing dirs are skipped, failed parameters are
+   * logged and skipped. Throw if snapshot is corrupted or of unknown version.
+   * @param dir : target dir
+   * @param data : snapshot data
+   * @param size : snapshot size
+   * @return : number of applied parameters
+   */
+  static size_t apply(AbsDir* dir, const char* data, size_t size);
+
+  /**
+   * Read file in one go and apply it to dir.
+   * @param dir : target dir
+   * @param path : snapshot file
+   * @return : number of applied parameters
+   */
+  static size_t load(AbsDir* dir, const std::string& path);
+
+private:
+  class Reader;
+  struct Record;
+  typedef std::map<AbsDir*, std::vector<AbsDir*> > ChildMap;
+
+  static void writeHeader(
+      std::string& buf, unsigned long long session, size_t generation);
+  /**
+   * @param session : session in header will be stored in it if it's not 0
+   * @return : generation in header
+   */
+  static size_t readHeader(Reader& reader, unsigned long long* session = 0);
+
+  /**
+   * Write record of dir without it's children, records of subtree in pre
+   * order make up the whole snapshot.
+   * @param numChildren : number of child records follow
+   * @param incremental : write only parameters changed after baseGeneration
+   * @param baseGeneration : generation of base snapshot
+   */
+  static void writeDir(AbsDir* dir, std::string& buf, size_t numChildren,
+      bool incremental = false, size_t baseGeneration = 0);
+  static void writeIncrementDir(AbsDir* dir, std::string& buf,
+      const ChildMap& childMap, size_t baseGeneration);
+  static void appendUint(std::string& buf, unsigned int v);
+  static void appendString(std::string& buf, const std::string& s);
+  static size_t applyDir(AbsDir* dir, Reader& reader);
+  static void readRecord(Record& record, Reader& reader);
+  static void overlayRecord(Record& dst, Record& src);
+  static void writeRecord(const Record& record, std::string& buf);
+};
+}
+
+#endif /* PACSNAPSHOT_H */
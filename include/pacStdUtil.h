@@ -3,6 +3,8 @@
 
 #include "pacConsolePreRequisite.h"
 #include <boost/regex.hpp>
+#include <exception>
+#include <thread>
 
 namespace pac {
 
@@ -35,6 +37,77 @@ public:
    */
   static std::string getIdenticalString(
       StringVector::iterator beg, StringVector::iterator end);
+
+  /**
+   * Split [0, n) into contiguous chunks, call f on each chunk in it's own
+   * thread, calling thread takes the 1st chunk. Block until all chunks are
+   * done. f must not throw.
+   * @param n : number of items
+   * @param grain : min number of items per thread
+   * @param f : functor of (size_t first, size_t last)
+   */
+  template <class F>
+  static void parallelFor(size_t n, size_t grain, F f) {
+    size_t numThreads = getMaxThreads();
+    numThreads = std::min(numThreads, n / std::max<size_t>(grain, 1));
+    if (numThreads <= 1) {
+      if (n != 0) f(0, n);
+      return;
+    }
+
+    size_t chunk = (n + numThreads - 1) / numThreads;
+    std::vector<std::thread> threads;
+    for (size_t first = chunk; first < n; first += chunk)
+      threads.push_back(std::thread(f, first, std::min(first + chunk, n)));
+    f(0, chunk);
+    std::for_each(threads.begin(), threads.end(),
+        [&](std::thread& v) -> void { v.join(); });
+  }
+
+  /**
+   * Split [0, n) into numChunks contiguous chunks of nearly equal size,
+   * process chunks by parallelFor. Use it when per chunk result must be
+   * combined in order, e.g. chunk buffers. f can throw, exception of each
+   * chunk is caught in it's thread, the one of the 1st failed chunk is
+   * rethrown in calling thread after all threads are joined.
+   * @param n : number of items
+   * @param numChunks : number of chunks, see getNumChunks
+   * @param f : functor of (size_t chunk, size_t first, size_t last)
+   */
+  template <class F>
+  static void parallelChunks(size_t n, size_t numChunks, F f) {
+    std::vector<std::exception_ptr> errors(numChunks);
+    parallelFor(numChunks, 1, [&](size_t beg, size_t end) -> void {
+      for (size_t i = beg; i < end; ++i) {
+        try {
+          f(i, i * n / numChunks, (i + 1) * n / numChunks);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    });
+    std::vector<std::exception_ptr>::iterator iter =
+        std::find_if(errors.begin(), errors.end(),
+            [&](const std::exception_ptr& v) -> bool { return v != nullptr; });
+    if (iter != errors.end()) std::rethrow_exception(*iter);
+  }
+
+  /**
+   * Number of chunks for parallelChunks. A few chunks per thread keeps
+   * threads busy if chunks are not equally expensive.
+   * @param n : number of items
+   * @param grain : min number of items per chunk
+   */
+  static size_t getNumChunks(size_t n, size_t grain);
+
+  /**
+   * Max number of threads used by parallelFor, 0 for hardware concurrency.
+   */
+  static void setMaxThreads(size_t v) { msMaxThreads = v; }
+  static size_t getMaxThreads();
+
+private:
+  static size_t msMaxThreads;
 };
 
 namespace fo {
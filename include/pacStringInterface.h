@@ -4,20 +4,86 @@
 #include "pacConsolePreRequisite.h"
 #include "pacStdUtil.h"
 #include "pacException.h"
+#include "pacParamValue.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 namespace pac {
 
 /**
- * Abstract class which is command object which gets/sets parameters.
+ * Abstract class which is command object which gets/sets parameters. String
+ * get and set are mandatory, commands of simple types can also implement
+ * typed get and set, which skip parsing, formatting and handler allocation.
  */
 class _PacExport ParamCmd {
 public:
-  ParamCmd(const std::string& _ahName) : ahName(_ahName) {}
+  ParamCmd(const std::string& _ahName, bool _deferrable = false)
+      : ahName(_ahName),
+        deferrable(_deferrable),
+        mValidator(0),
+        mValidatorBusy(false) {}
+  /**
+   * Validator is not copied, copy creates it's own.
+   */
+  ParamCmd(const ParamCmd& rhs);
+  ParamCmd& operator=(const ParamCmd& rhs);
+
+  /**
+   * Validate val, then set it through doSet(void*, ArgHandler*). Validator is
+   * created at 1st call and reused after, so bulk set allocates no handler.
+   */
   void doSet(void* target, const std::string& val);
   virtual std::string doGet(const void* target) const = 0;
   virtual void doSet(void* target, ArgHandler* handler);
-  virtual ~ParamCmd() {}
+
+  /**
+   * Typed get.
+   * @param target : string interface
+   * @param value : output value
+   * @return : false if typed get is not supported
+   */
+  virtual bool doGetValue(const void* target, ParamValue& value) const {
+    (void)target;
+    (void)value;
+    return false;
+  }
+
+  /**
+   * Typed set, throw if value is of wrong type.
+   * @param target : string interface
+   * @param value : new value
+   * @return : false if typed set is not supported
+   */
+  virtual bool doSetValue(void* target, const ParamValue& value) {
+    (void)target;
+    (void)value;
+    return false;
+  }
+  virtual ~ParamCmd();
+
+  /**
+   * Validate val with reusable validator.
+   * @param val : parameter value
+   * @return : true if val is valid
+   */
+  bool validate(const std::string& val);
+
   std::string ahName;  // argument handler name
+  // set absolute state, repeated writes can be deferred and coalesced
+  bool deferrable;
+
+private:
+  /**
+   * @return : validator of this, or a new handler if it's busy, which
+   * happens if doSet reenters doSet of this.
+   */
+  ArgHandler* acquireValidator();
+  void releaseValidator(ArgHandler* handler);
+
+private:
+  ArgHandler* mValidator;  // created on demand
+  bool mValidatorBusy;
 };
 
 class _PacExport ReadonlyParamCmd : public ParamCmd {
@@ -40,18 +106,25 @@ public:
       : name(_name), desc(_desc), paramCmd(_paramCmd) {}
 };
 
-typedef std::map<std::string, ParamDef> ParamMap;
-// typedef std::vector<std::string> Params;
+typedef std::vector<ParamDef> ParamDefs;
 
 /**
- * Class to hold a dictionary of parameters for a single class.
+ * Class to hold a dictionary of parameters for a single class. Dictionary is
+ * built once per class, definitions are kept in a flat vector sorted by name,
+ * names are looked up in an open addressing hash table of indices which is
+ * rebuilt at every add, so lookup costs a hash and usually a single string
+ * compare, and name enumeration is a view, not a copy.
  */
 class _PacExport ParamDictionary {
   friend class StringInterface;
 
 protected:
-  /// Definitions of parameters
-  ParamMap mParamMap;
+  /// Definitions of parameters, sorted by name
+  ParamDefs mParamDefs;
+  /// Names of mParamDefs, in the same order
+  StringVector mNames;
+  /// Index + 1 into mParamDefs, 0 means empty slot, size is power of 2
+  SizetVector mSlots;
 
   /**
    * Retrieves the parameter command object for a named parameter.
@@ -67,11 +140,19 @@ protected:
    */
   const std::string& getParamAhName(const std::string& name) const;
 
+  /**
+   * @return : index of name in mParamDefs, -1 if not found.
+   */
+  size_t findParamDef(const std::string& name) const;
+
+  void rehash();
+
 public:
   ParamDictionary() {}
 
   /**
-   * Method for adding a parameter definition for this class.
+   * Method for adding a parameter definition for this class. Existing
+   * definition of the same name is kept.
    * @param paramDef : A ParamDef object defining the parameter
    */
   void addParameter(const ParamDef& paramDef);
@@ -81,11 +162,18 @@ public:
 
   /**
    * Retrieve parameter name list.
-   * @return : vector of parameter names
+   * @return : parameter names in name order, it's invalidated by
+   * addParameter.
    */
-  StringVector getParameters(void) const;
+  const StringVector& getParameters(void) const { return mNames; }
+
+  const ParamDefs& getParamDefs() const { return mParamDefs; }
+
+  bool hasParameter(const std::string& name) const {
+    return findParamDef(name) != static_cast<size_t>(-1);
+  }
 };
-typedef std::map<std::string, ParamDictionary> ParamDictionaryMap;
+typedef std::unordered_map<std::string, ParamDictionary> ParamDictionaryMap;
 
 /**
  * Class defining the common interface which classes can use to present a
@@ -111,13 +199,24 @@ protected:
 
 public:
   StringInterface(const std::string& name, bool wrapper)
-      : mWrapper(wrapper), mName(name), mParamDict(NULL) {}
-  virtual ~StringInterface() {}
+      : mWrapper(wrapper), mName(name), mParamDict(NULL), mOwnerDir(0) {}
+  virtual ~StringInterface();
 
   ParamDictionary* getParamDict(void) { return mParamDict; }
   const ParamDictionary* getParamDict(void) const { return mParamDict; }
 
-  virtual StringVector getParameters(void) const;
+  /**
+   * Get parameter names, it's a view of class dictionary for most string
+   * interfaces, don't keep it.
+   * @return : parameter names
+   */
+  virtual const StringVector& getParameters(void) const;
+
+  /**
+   * @param name : parameter name
+   * @return : true if parameter exists
+   */
+  virtual bool hasParameter(const std::string& name) const;
 
   /**
    * Set parameter value. It doesn't matter if specified prameter doesn't
@@ -136,6 +235,27 @@ public:
    */
   virtual bool setParameter(const std::string& name, ArgHandler* handler);
 
+  /**
+   * Typed set. It skips string parsing, validation and handler allocation,
+   * pending deferred writes of this are applied before it to keep write
+   * order. In deferred mode writes to deferrable params are recorded like
+   * string ones, type and range are only checked at commit, where failures
+   * are logged.
+   * @param name : parameter name
+   * @param value : parameter value
+   * @return : false if parameter not found or it doesn't support typed set
+   */
+  virtual bool setValue(const std::string& name, const ParamValue& value);
+
+  /**
+   * Typed get. It returns pending value of deferred typed write, pending
+   * string write is not visible to it.
+   * @param name : parameter name
+   * @param value : output value
+   * @return : false if parameter not found or it doesn't support typed get
+   */
+  virtual bool getValue(const std::string& name, ParamValue& value) const;
+
   /**
    * Generic multiple parameter setting method.
    * @param paramList : name/value pair list
@@ -143,7 +263,9 @@ public:
   virtual void setParameterList(const NameValuePairList& paramList);
 
   /**
-   * Get parameter value.
+   * Get parameter value. It's safe to call it from several threads as long
+   * as no parameter is set at the same time, doGet of every ParamCmd must be
+   * free of side effects for this.
    * @param name : parameter name
    * @return : parameter value
    */
@@ -172,6 +294,27 @@ public:
 
   static void cleanupDictionary();
 
+  /**
+   * Turn on or off deferred mode. In deferred mode, writes to deferrable
+   * params are validated but not applied, they are recorded and coalesced per
+   * (string interface, param), the last write wins. Pending writes are
+   * applied at commitParameters. getParameter returns pending value of
+   * string write, getValue returns pending value of typed write, otherwise
+   * they return applied state.
+   * @param v : true to defer, false to apply pending writes and stop deferring
+   */
+  static void setDeferred(bool v);
+  static bool getDeferred() { return msDeferred; }
+
+  /**
+   * Apply all pending writes in the order they were first recorded. Failed
+   * writes are logged and skipped. Call it once per frame in deferred mode.
+   * @return : number of applied writes
+   */
+  static size_t commitParameters();
+
+  static size_t getNumPendingParameters() { return msPendingIndex.size(); }
+
   /**
    * called when dir was created with this string interface
    */
@@ -180,10 +323,40 @@ public:
   bool getWrapper() const { return mWrapper; }
   void setWrapper(bool v) { mWrapper = v; }
 
+  /**
+   * Dir which owns this string interface, it's set by AbsDir.
+   */
+  AbsDir* getOwnerDir() const { return mOwnerDir; }
+  void setOwnerDir(AbsDir* v) { mOwnerDir = v; }
+
+  /**
+   * @param name : parameter name
+   * @return : change generation of last successful set of name, 0 if it's
+   * never set.
+   */
+  size_t getParamGeneration(const std::string& name) const;
+
+  /**
+   * Global change generation, it's bumped by every successful set, see
+   * markChanged.
+   */
+  static size_t getChangeGeneration() { return msChangeGeneration; }
+
   const std::string& getName() const { return mName; }
   void setName(const std::string& v) { mName = v; }
 
 protected:
+  /**
+   * Record change of parameter with a new change generation, and mark owning
+   * dir dirty. Subclasses which override setParameter must call it after
+   * every successful set.
+   * @param name : parameter name
+   */
+  void markChanged(const std::string& name);
+
+protected:
+  typedef std::map<std::string, size_t> ParamGenerations;
+
   bool mWrapper;
   std::string mName;
   // Dictionary of parameters
@@ -193,6 +366,56 @@ protected:
   ParamDictionary* mParamDict;
 
   static ParamDictionaryMap msDictionary;
+
+  AbsDir* mOwnerDir;
+  ParamGenerations mParamGenerations;  // changed params only
+  static size_t msChangeGeneration;
+
+private:
+  /**
+   * Record or overwrite pending write.
+   * @param name : parameter name
+   * @param cmd : param cmd of name
+   * @param value : validated value
+   */
+  void deferParameter(
+      const std::string& name, ParamCmd* cmd, const std::string& value);
+  void deferValue(
+      const std::string& name, ParamCmd* cmd, const ParamValue& value);
+
+  /**
+   * Apply pending writes of this. Called before non deferrable write to keep
+   * write order.
+   * @param discard : drop pending writes instead of applying them
+   */
+  void flushPendingParameters(bool discard = false);
+
+  struct PendingParam {
+    StringInterface* si;  // 0 if discarded
+    ParamCmd* cmd;
+    std::string value;
+    ParamValue typedValue;  // PVT_NONE if it's a string write
+
+    bool isTyped() const {
+      return typedValue.getType() != ParamValue::PVT_NONE;
+    }
+    void apply(StringInterface* target);
+  };
+
+  /**
+   * Find or create pending write, caller must hold msPendingMutex.
+   */
+  PendingParam& getPendingParam(const std::string& name, ParamCmd* cmd);
+  typedef std::vector<PendingParam> PendingParams;
+  typedef std::map<std::pair<const StringInterface*, std::string>, size_t>
+      PendingIndex;
+
+  static bool msDeferred;
+  static PendingParams msPendingParams;
+  static PendingIndex msPendingIndex;  // (si, param) to index of pending
+  // guard pending writes against concurrent getParameter
+  static std::mutex msPendingMutex;
+  static std::atomic<size_t> msNumPending;  // size of msPendingIndex
 };
 }
 
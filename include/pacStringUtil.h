@@ -139,6 +139,14 @@ left to right.
   static std::string join(
       SVCIter first, SVCIter last, const std::string& sep = " ");
 
+  /**
+   * Append json string literal, quotes included.
+   * @param dst : destination string
+   * @param data : utf8 text
+   * @param size : text size
+   */
+  static void appendJsonString(std::string& dst, const char* data, size_t size);
+
   /**
    * Extend string to fixed length
    * @param s : strign
@@ -228,6 +236,13 @@ left to right.
   std::string.
   */
   static Real parseReal(const std::string& val, Real defaultValue = 0);
+  /**
+   * Parse space separated reals, it doesn't build any intermediate string.
+   * @param val : string of reals
+   * @param reals : reals will be appended to it
+   * @return : false if val contains anything other than reals
+   */
+  static bool parseReals(const std::string& val, RealVector& reals);
   /** Converts a std::string to a whole number.
   @return
       0.0 if the value could not be parsed, otherwise the numeric version of the
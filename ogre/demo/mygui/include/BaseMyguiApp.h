@@ -113,6 +113,10 @@ protected:
   bool mCursorWasVisible;  // Was cursor visible before dialog appeared?
   bool mShutDown;
   bool mExecuteing;
+  // ctrl-r reverse search state, pattern is cmd line typed before 1st ctrl-r
+  bool mSearching;
+  size_t mSearchSkip;
+  std::string mSearchPattern;
 
   // OIS Input devices
   OIS::InputManager* mInputManager;
@@ -11,7 +11,6 @@ namespace pac {
 class _PacExport MyguiConsoleUI : public ConsoleUI {
 public:
   MyguiConsoleUI();
-  virtual void output(const std::string& output, int type = 1);
   virtual void setCwd(const std::string& cwd);
   virtual void setCmdLine(const std::string& cmdLine);
   virtual std::string getCmdLine();
@@ -24,6 +23,10 @@ public:
   virtual Real getOutputWidgetWidth() const ;
   virtual Real getFontWidth() const ;
 
+protected:
+  virtual void appendOutput(const std::string& text, int type);
+  virtual void evictOutput(size_t numChars);
+
 private:
   void buildGui();
 
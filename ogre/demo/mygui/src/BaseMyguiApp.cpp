@@ -1,4 +1,6 @@
 #include "BaseMyguiApp.h"
+#include "pacStringInterface.h"
+#include "pacCmdHistory.h"
 #include <OgreFrameStats.h>
 #include <Compositor/OgreCompositorManager2.h>
 #include <Compositor/OgreCompositorNodeDef.h>
@@ -24,6 +26,8 @@ BaseMyguiApp::BaseMyguiApp(void)
       mCursorWasVisible(false),
       mShutDown(false),
       mExecuteing(false),
+      mSearching(false),
+      mSearchSkip(0),
       mInputManager(0),
       mMouse(0),
       mKeyboard(0),
@@ -332,6 +336,9 @@ void BaseMyguiApp::initConsole() {
   // mConsole = new OgreConsole("mSceneMgr")
   mConsole = new pac::OgreConsole(mConsoleUI, mSceneMgr);
   mConsole->init();
+  mConsole->getCmdHistory()->load("console_history");
+  // transform params are applied once per frame at OgreConsole::frameStarted
+  pac::StringInterface::setDeferred(true);
 }
 
 //---------------------------------------------------------------------------
@@ -343,6 +350,24 @@ bool BaseMyguiApp::keyPressed(const OIS::KeyEvent &arg) {
     mConsole->toggleActive();
     return true;
   }
+
+  if (mConsole->isActive() && arg.key == OIS::KC_R &&
+      mKeyboard->isModifierDown(OIS::Keyboard::Ctrl)) {
+    // reverse search, repeat ctrl-r to search older command lines
+    if (mSearching) {
+      ++mSearchSkip;
+    } else {
+      mSearching = true;
+      mSearchSkip = 0;
+      mSearchPattern = mConsoleUI->getCmdLine();
+    }
+    // stay at the oldest match
+    if (!mConsole->searchCommand(mSearchPattern, mSearchSkip) && mSearchSkip)
+      --mSearchSkip;
+    return true;
+  }
+  if (arg.key != OIS::KC_LCONTROL && arg.key != OIS::KC_RCONTROL)
+    mSearching = false;
   MyGUI::InputManager::getInstance().injectKeyPress(
       MyGUI::KeyCode::Enum(arg.key), arg.text);
 
@@ -28,8 +28,13 @@ MyguiConsoleUI::MyguiConsoleUI()
 }
 
 //------------------------------------------------------------------------------
-void MyguiConsoleUI::output(const std::string& output, int type /*= 1*/) {
-  mwOutput->setCaption(mwOutput->getCaption() + output);
+void MyguiConsoleUI::appendOutput(const std::string& text, int type) {
+  mwOutput->addText(text);
+}
+
+//------------------------------------------------------------------------------
+void MyguiConsoleUI::evictOutput(size_t numChars) {
+  mwOutput->eraseText(0, numChars);
 }
 
 //------------------------------------------------------------------------------
@@ -3,12 +3,21 @@
 
 #include "OgreConsolePreRequisite.h"
 #include "pacConsole.h"
+#include <OgreFrameListener.h>
 
 namespace pac {
 
-class _PacExport OgreConsole : public Console {
+/**
+ * Ogre console. It commits deferred parameters and samples watched
+ * parameters at frameStarted, turn on StringInterface::setDeferred if you want
+ * repeated set of transform params in the same frame cost only 1 update.
+ */
+class _PacExport OgreConsole : public Console, public Ogre::FrameListener {
 public:
   OgreConsole(ConsoleUI* ui, Ogre::SceneManager* sceneMgr);
+  virtual ~OgreConsole();
+
+  virtual bool frameStarted(const Ogre::FrameEvent& evt);
 
   virtual bool execute(const std::string& cmdLine = "");
   /**
@@ -3,6 +3,7 @@
 
 #include "OgreConsolePreRequisite.h"
 #include "pacStringInterface.h"
+#include "pacAbsDir.h"
 #include "OgreMovableObject.h"
 #include "OgreSiWrapper.h"
 
@@ -13,17 +14,95 @@ public:
   static StringInterface* createMovableSI(Ogre::MovableObject* mo);
 };
 
+/**
+ * Children of movable dir, read straight from scene manager. Child name is
+ * nameid of movable object.
+ *
+ * Lookup goes through an index of id to position in scene manager's
+ * collections, it's rebuilt by getChildNames, for ids above the indexed ones
+ * (ids are never reused, so only they can be new objects), and when a
+ * position is stale because objects were destroyed.
+ */
+class _PacExport MovableProvider : public ChildProvider {
+public:
+  MovableProvider(Ogre::SceneManager* sceneMgr)
+      : mSceneMgr(sceneMgr), mMaxId(0) {}
+
+  virtual void getChildNames(StringVector& names);
+  virtual bool hasChild(const std::string& name);
+  virtual StringInterface* createStringInterface(const std::string& name);
+
+private:
+  /**
+   * @param nameid : name@id
+   * @return : 0 if not found
+   */
+  Ogre::MovableObject* findMovable(const std::string& nameid);
+
+  /**
+   * Rebuild index from scene manager.
+   * @param names : nameids will be appended to it if it's not 0
+   */
+  void buildIndex(StringVector* names);
+
+  /**
+   * @param type : index of type in movable types
+   * @param index : position in collection of type
+   * @return : 0 if position is out of range
+   */
+  Ogre::MovableObject* getMovableAt(size_t type, size_t index);
+
+private:
+  struct Slot {
+    size_t type;
+    size_t index;
+  };
+  typedef std::map<Ogre::IdType, Slot> SlotMap;
+
+  Ogre::SceneManager* mSceneMgr;
+  SlotMap mSlots;
+  Ogre::IdType mMaxId;
+};
+
+/**
+ * Children of node dir, read straight from scene manager. Child name is
+ * nameid of scene node.
+ */
+class _PacExport SceneNodeProvider : public ChildProvider {
+public:
+  SceneNodeProvider(Ogre::SceneManager* sceneMgr) : mSceneMgr(sceneMgr) {}
+
+  virtual void getChildNames(StringVector& names);
+  virtual bool hasChild(const std::string& name);
+  virtual StringInterface* createStringInterface(const std::string& name);
+
+private:
+  /**
+   * @param nameid : name@id
+   * @return : 0 if not found
+   */
+  Ogre::SceneNode* findSceneNode(const std::string& nameid);
+  void appendNodeNames(Ogre::Node* node, StringVector& names);
+
+private:
+  Ogre::SceneManager* mSceneMgr;
+};
+
 class _PacExport MovableSI : public StringInterface {
 public:
   struct _PacExport Visible : public ParamCmd {
     Visible() : ParamCmd("bool") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
   struct _PacExport ParentNode : public ParamCmd {
     ParentNode() : ParamCmd("t_sceneNode") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
   MovableSI(Ogre::MovableObject* obj);
   Ogre::MovableObject* getMovable() const;
@@ -43,6 +122,8 @@ public:
     LightType() : ParamCmd("en_lightType") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
 
@@ -50,18 +131,24 @@ public:
     Diffuse() : ParamCmd("nreal3") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport Specular : public ParamCmd {
     Specular() : ParamCmd("nreal3") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport Direction : public ParamCmd {
     Direction() : ParamCmd("real3") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport SpotOuter : public ParamCmd {
@@ -104,6 +191,8 @@ public:
     PowerScale() : ParamCmd("real") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport ShadowFarDist : public ParamCmd {
@@ -136,15 +225,19 @@ protected:
 class _PacExport CameraSI : public MovableSI {
 public:
   struct _PacExport Position : public ParamCmd {
-    Position() : ParamCmd("real3") {}
+    Position() : ParamCmd("real3", true) {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport PolygonMode : public ParamCmd {
     PolygonMode() : ParamCmd("en_polygonMode") {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport Direction : public ParamCmd {
@@ -154,9 +247,11 @@ public:
   };
 
   struct _PacExport Orientation : public ParamCmd {
-    Orientation() : ParamCmd("quaternion") {}
+    Orientation() : ParamCmd("quaternion", true) {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   CameraSI(Ogre::Camera* camera);
@@ -184,22 +279,28 @@ protected:
 class _PacExport NodeSI : public StringInterface {
 public:
   struct _PacExport Position : public ParamCmd {
-    Position() : ParamCmd("real3") {}
+    Position() : ParamCmd("real3", true) {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport Scale : public ParamCmd {
-    Scale() : ParamCmd("real3") {}
+    Scale() : ParamCmd("real3", true) {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
   
 
   struct _PacExport Orientation : public ParamCmd {
-    Orientation() : ParamCmd("quaternion") {}
+    Orientation() : ParamCmd("quaternion", true) {}
     virtual std::string doGet(const void* target) const;
     virtual void doSet(void* target, ArgHandler* handler);
+    virtual bool doGetValue(const void* target, ParamValue& value) const;
+    virtual bool doSetValue(void* target, const ParamValue& value);
   };
 
   struct _PacExport Parent : public ReadonlyParamCmd {
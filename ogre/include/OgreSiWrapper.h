@@ -6,13 +6,21 @@
 
 namespace pac {
 
+/**
+ * Per ogre class arg handlers and parameter names, shared by all wrappers of
+ * the same class.
+ */
 class AhDict {
 public:
   void bindArgHandler(const std::string& param, const std::string& ahName);
   const std::string& getParamAhName(const std::string& param);
 
+  void addParameter(const std::string& param);
+  const StringVector& getParameters() const { return mParameters; }
+
 private:
   StrStrMap mMap;
+  StringVector mParameters;
 };
 
 typedef std::map<std::string, AhDict> ParamAhDictMap;
@@ -24,13 +32,14 @@ class OgreSiWrapper : public StringInterface {
 public:
   OgreSiWrapper(const std::string& name, Ogre::StringInterface* si);
 
+  virtual bool setParameter(const std::string& name, const std::string& value);
   virtual bool setParameter(const std::string& name, ArgHandler* handler);
 
   virtual std::string getParameter(const std::string& name) const;
 
   const std::string& getValueArgHandler(const std::string& name);
 
-  virtual StringVector getParameters(void) const;
+  virtual const StringVector& getParameters(void) const;
 
 
   bool createaAhDict();
@@ -19,6 +19,11 @@ public:
       Ogre::SceneManager* mgr, Ogre::IdType id);
   static Ogre::SceneNode* getSceneNodeByIdNoThrow(
       Ogre::SceneManager* mgr, Ogre::IdType id);
+  /**
+   * Same as getSceneNodeByIdNoThrow, but miss is not logged, used by probes.
+   */
+  static Ogre::SceneNode* findSceneNodeById(
+      Ogre::SceneManager* mgr, Ogre::IdType id);
 
   static std::tuple<Ogre::IdType, std::string> parseIdtype(
       const std::string& it);
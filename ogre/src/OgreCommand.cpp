@@ -34,7 +34,7 @@ void outputMovable(
     const std::string&& nameid = OgreUtil::createNameid(mo);
     if ((reExp.empty() || boost::regex_match(nameid, regex)) &&
         (moType.empty() || moType == mo->getMovableType()))
-      sgConsole.output(nameid);
+      sgConsole.outputRecord({{"name", nameid}});
   }
 }
 
@@ -72,7 +72,7 @@ bool LsresCmd::doExecute() {
     while (oi.hasMoreElements()) {
       Ogre::ResourcePtr ptr = oi.getNext();
       if (reExp.empty() || boost::regex_match(ptr->getName(), regex))
-        sgConsole.output(ptr->getName());
+        sgConsole.outputRecord({{"name", ptr->getName()}});
     }
     if (resType == "mesh" || resType == "texture") {
       // output fixed item for mesh and texture
@@ -85,7 +85,7 @@ bool LsresCmd::doExecute() {
               auto iter = std::find_if(oi.begin(), oi.end(),
                   [&](Ogre::ResourceManager::ResourceHandleMap::value_type p)
                       -> bool { return p.second->getName() == v; });
-              if (iter == oi.end()) sgConsole.output(v);
+              if (iter == oi.end()) sgConsole.outputRecord({{"name", v}});
             }
           });
     }
@@ -96,7 +96,7 @@ bool LsresCmd::doExecute() {
     while (oi.hasMoreElements()) {
       auto ps = oi.getNext();
       if (reExp.empty() || boost::regex_match(ps->getName(), regex))
-        sgConsole.output(ps->getName());
+        sgConsole.outputRecord({{"name", ps->getName()}});
     }
   }
 
@@ -153,7 +153,7 @@ bool LsndCmd::doExecute() {
       if (hasOption('r'))
         outputNode(n, smmt);
       else if (smmt < 0 || smmt == OgreUtil::getSceneType(n))
-        sgConsole.output(OgreUtil::createNameid(n));
+        sgConsole.outputRecord({{"name", OgreUtil::createNameid(n)}});
     }
 
   } else if (branch[0] == 'r') {
@@ -167,7 +167,8 @@ bool LsndCmd::doExecute() {
     Ogre::SceneNode* node = OgreUtil::getSceneNodeById(
         sceneMgr, handler->getMatchedNodeUniformValue("sceneNode"));
     if (node->getParent())
-      sgConsole.output(OgreUtil::createNameid(node->getParent()));
+      sgConsole.outputRecord(
+          {{"name", OgreUtil::createNameid(node->getParent())}});
 
   } else if (branch == "pm0") {
     // lsnd ltl_parentOfMovable moType movable ("pm0")
@@ -175,7 +176,8 @@ bool LsndCmd::doExecute() {
         sceneMgr, handler->getMatchedNodeUniformValue("movable"));
     if (mo->isAttached())
       //@TODO check bont attach
-      sgConsole.output(OgreUtil::createNameid(mo->getParentNode()));
+      sgConsole.outputRecord(
+          {{"name", OgreUtil::createNameid(mo->getParentNode())}});
 
   } else {
     PAC_EXCEPT(Exception::ERR_INVALID_STATE, "invalid branch:" + branch);
@@ -212,8 +214,9 @@ bool LsndCmd::buildArgHandler() {
 
 //------------------------------------------------------------------------------
 void LsndCmd::outputNode(const Ogre::Node* node, int smmt) {
+  if (sgConsole.isOutputCancelled()) return;
   if (smmt < 0 || OgreUtil::getSceneType(node) == smmt)
-    sgConsole.output(OgreUtil::createNameid(node));
+    sgConsole.outputRecord({{"name", OgreUtil::createNameid(node)}});
   auto oi = node->getChildIterator();
   while (oi.hasMoreElements()) outputNode(oi.getNext(), smmt);
 }
@@ -221,10 +224,11 @@ void LsndCmd::outputNode(const Ogre::Node* node, int smmt) {
 //------------------------------------------------------------------------------
 void LsndCmd::outputNode(
     const Ogre::Node* node, int smmt, boost::regex& regex) {
+  if (sgConsole.isOutputCancelled()) return;
   const std::string&& nameid = OgreUtil::createNameid(node);
   if ((smmt < 0 || OgreUtil::getSceneType(node) == smmt) &&
       boost::regex_match(nameid, regex))
-    sgConsole.output(nameid);
+    sgConsole.outputRecord({{"name", nameid}});
 
   auto oi = node->getChildIterator();
   while (oi.hasMoreElements()) outputNode(oi.getNext(), smmt, regex);
@@ -547,8 +551,8 @@ bool EdmoCmd::doExecute() {
 
   Ogre::MovableObject* mo =
       OgreUtil::getMovableByIdtype(sceneMgr, handler->getUniformValue());
-  AbsDir* dir = sgOgreConsole.getMovableDir()->addUniqueChild(
-      OgreUtil::createNameid(mo), OgreSiUtil::createMovableSI(mo));
+  AbsDir* dir =
+      sgOgreConsole.getMovableDir()->getChildByName(OgreUtil::createNameid(mo));
   sgConsole.setCwd(dir);
   return true;
 }
@@ -564,8 +568,8 @@ bool EdndCmd::doExecute() {
 
   Ogre::SceneNode* sceneNode =
       OgreUtil::getSceneNodeById(sceneMgr, handler->getUniformValue());
-  AbsDir* dir = sgOgreConsole.getNodeDir()->addUniqueChild(
-      OgreUtil::createNameid(sceneNode), new SceneNodeSI(sceneNode));
+  AbsDir* dir = sgOgreConsole.getNodeDir()->getChildByName(
+      OgreUtil::createNameid(sceneNode));
   sgConsole.setCwd(dir);
   return true;
 }
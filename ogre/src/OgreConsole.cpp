@@ -6,11 +6,14 @@
 #include "pacArgHandler.h"
 #include "pacAbsDir.h"
 #include "pacEnumUtil.h"
+#include "pacStringInterface.h"
+#include "pacParamWatch.h"
 #include <OgreMaterialManager.h>
 #include <OgreMeshManager.h>
 #include <OgreTextureManager.h>
 #include <OgreParticleSystemManager.h>
 #include <OgreSceneManager.h>
+#include <OgreRoot.h>
 //#include <OgreCompositorManager.h>
 #include <OgreNode.h>
 
@@ -39,7 +42,24 @@ DEFINE_ENUM_CONVERSION(
 
 //------------------------------------------------------------------------------
 OgreConsole::OgreConsole(ConsoleUI* ui, Ogre::SceneManager* sceneMgr)
-    : Console(ui), mSceneMgr(sceneMgr), mMovableDir(0), mNodeDir(0) {}
+    : Console(ui), mSceneMgr(sceneMgr), mMovableDir(0), mNodeDir(0) {
+  Ogre::Root* root = Ogre::Root::getSingletonPtr();
+  if (root) root->addFrameListener(this);
+}
+
+//------------------------------------------------------------------------------
+OgreConsole::~OgreConsole() {
+  Ogre::Root* root = Ogre::Root::getSingletonPtr();
+  if (root) root->removeFrameListener(this);
+}
+
+//------------------------------------------------------------------------------
+bool OgreConsole::frameStarted(const Ogre::FrameEvent& evt) {
+  (void)evt;
+  StringInterface::commitParameters();
+  ParamWatch::sample();
+  return true;
+}
 
 //------------------------------------------------------------------------------
 bool OgreConsole::execute(const std::string& cmdLine /*= ""*/) {
@@ -80,8 +100,8 @@ void OgreConsole::initDir() {
   Console::initDir();
 
   mSceneDir = new AbsDir("scene", new SceneManagerSI(mSceneMgr));
-  mMovableDir = new AbsDir("movable");
-  mNodeDir = new AbsDir("node");
+  mMovableDir = new VirtualDir("movable", new MovableProvider(mSceneMgr));
+  mNodeDir = new VirtualDir("node", new SceneNodeProvider(mSceneMgr));
 
   sgRootDir.addChild(mSceneDir, false);
   sgRootDir.addChild(mMovableDir, false);
@@ -62,6 +62,133 @@ StringInterface* OgreSiUtil::createMovableSI(Ogre::MovableObject* mo) {
         "unknown movable type " + mo->getMovableType());
 }
 
+// camera is kept apart from other movables by scene manager, it must be last
+static const char* movableTypes[] = {
+    "ParticleSystem", "Light", "Entity", "Camera"};
+static const size_t numMovableTypes =
+    sizeof(movableTypes) / sizeof(movableTypes[0]);
+
+//------------------------------------------------------------------------------
+void MovableProvider::getChildNames(StringVector& names) {
+  buildIndex(&names);
+}
+
+//------------------------------------------------------------------------------
+bool MovableProvider::hasChild(const std::string& name) {
+  return findMovable(name) != 0;
+}
+
+//------------------------------------------------------------------------------
+StringInterface* MovableProvider::createStringInterface(
+    const std::string& name) {
+  Ogre::MovableObject* mo = findMovable(name);
+  return mo ? OgreSiUtil::createMovableSI(mo) : 0;
+}
+
+//------------------------------------------------------------------------------
+Ogre::MovableObject* MovableProvider::findMovable(const std::string& nameid) {
+  Ogre::IdType id = OgreUtil::getIdFromNameid(nameid);
+  if (id == OgreUtil::nid) return 0;
+
+  if (id > mMaxId) buildIndex(0);
+  SlotMap::iterator iter = mSlots.find(id);
+  if (iter == mSlots.end()) return 0;
+
+  Ogre::MovableObject* mo = getMovableAt(iter->second.type, iter->second.index);
+  if (!mo || mo->getId() != id) {
+    // destroyed objects are swapped out, positions after them moved
+    buildIndex(0);
+    iter = mSlots.find(id);
+    if (iter == mSlots.end()) return 0;
+    mo = getMovableAt(iter->second.type, iter->second.index);
+  }
+  return mo && OgreUtil::createNameid(mo) == nameid ? mo : 0;
+}
+
+//------------------------------------------------------------------------------
+void MovableProvider::buildIndex(StringVector* names) {
+  mSlots.clear();
+  mMaxId = 0;
+  auto add = [&](size_t type, size_t index, Ogre::MovableObject* mo) -> void {
+    Slot slot = {type, index};
+    mSlots[mo->getId()] = slot;
+    mMaxId = std::max(mMaxId, mo->getId());
+    if (names) names->push_back(OgreUtil::createNameid(mo));
+  };
+
+  for (size_t type = 0; type < numMovableTypes - 1; ++type) {
+    auto oi = mSceneMgr->getMovableObjectIterator(movableTypes[type]);
+    for (auto iter = oi.begin(); iter != oi.end(); ++iter)
+      add(type, iter - oi.begin(), *iter);
+  }
+  auto ci = mSceneMgr->getCameraIterator();
+  for (auto iter = ci.begin(); iter != ci.end(); ++iter)
+    add(numMovableTypes - 1, iter - ci.begin(), *iter);
+}
+
+//------------------------------------------------------------------------------
+Ogre::MovableObject* MovableProvider::getMovableAt(size_t type, size_t index) {
+  if (type == numMovableTypes - 1) {
+    auto oi = mSceneMgr->getCameraIterator();
+    if (index >= static_cast<size_t>(oi.end() - oi.begin())) return 0;
+    return oi.begin()[index];
+  }
+
+  auto oi = mSceneMgr->getMovableObjectIterator(movableTypes[type]);
+  if (index >= static_cast<size_t>(oi.end() - oi.begin())) return 0;
+  return oi.begin()[index];
+}
+
+//------------------------------------------------------------------------------
+void SceneNodeProvider::getChildNames(StringVector& names) {
+  appendNodeNames(mSceneMgr->getRootSceneNode(Ogre::SCENE_DYNAMIC), names);
+  appendNodeNames(mSceneMgr->getRootSceneNode(Ogre::SCENE_STATIC), names);
+}
+
+//------------------------------------------------------------------------------
+bool SceneNodeProvider::hasChild(const std::string& name) {
+  return findSceneNode(name) != 0;
+}
+
+//------------------------------------------------------------------------------
+StringInterface* SceneNodeProvider::createStringInterface(
+    const std::string& name) {
+  Ogre::SceneNode* node = findSceneNode(name);
+  return node ? new SceneNodeSI(node) : 0;
+}
+
+//------------------------------------------------------------------------------
+Ogre::SceneNode* SceneNodeProvider::findSceneNode(const std::string& nameid) {
+  Ogre::IdType id = OgreUtil::getIdFromNameid(nameid);
+  if (id == OgreUtil::nid) return 0;
+
+  // probed by completion and hasChild, misses are not worth logging
+  Ogre::SceneNode* node = OgreUtil::findSceneNodeById(mSceneMgr, id);
+  return node && OgreUtil::createNameid(node) == nameid ? node : 0;
+}
+
+//------------------------------------------------------------------------------
+void SceneNodeProvider::appendNodeNames(Ogre::Node* node, StringVector& names) {
+  names.push_back(OgreUtil::createNameid(node));
+  auto oi = node->getChildIterator();
+  while (oi.hasMoreElements()) appendNodeNames(oi.getNext(), names);
+}
+
+//------------------------------------------------------------------------------
+static ParamValue makeVector3(const Ogre::Vector3& v) {
+  return ParamValue::makeReals(v.ptr(), 3);
+}
+
+//------------------------------------------------------------------------------
+static ParamValue makeQuaternion(const Ogre::Quaternion& q) {
+  return ParamValue::makeReals(q.ptr(), 4);
+}
+
+//------------------------------------------------------------------------------
+static ParamValue makeColour3(const Ogre::ColourValue& c) {
+  return ParamValue::makeReals(c.ptr(), 3);
+}
+
 //------------------------------------------------------------------------------
 std::string MovableSI::Visible::doGet(const void* target) const {
   Ogre::MovableObject* mo = static_cast<const MovableSI*>(target)->getMovable();
@@ -74,6 +201,21 @@ void MovableSI::Visible::doSet(void* target, ArgHandler* handler) {
   mo->setVisible(Ogre::StringConverter::parseBool(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool MovableSI::Visible::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::MovableObject* mo = static_cast<const MovableSI*>(target)->getMovable();
+  value = ParamValue::makeBool(mo->getVisible());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool MovableSI::Visible::doSetValue(void* target, const ParamValue& value) {
+  Ogre::MovableObject* mo = static_cast<const MovableSI*>(target)->getMovable();
+  mo->setVisible(value.getBool());
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string MovableSI::ParentNode::doGet(const void* target) const {
   Ogre::MovableObject* mo = static_cast<const MovableSI*>(target)->getMovable();
@@ -92,6 +234,25 @@ void MovableSI::ParentNode::doSet(void* target, ArgHandler* handler) {
   node->attachObject(mo);
 }
 
+//------------------------------------------------------------------------------
+bool MovableSI::ParentNode::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::MovableObject* mo = static_cast<const MovableSI*>(target)->getMovable();
+  value = ParamValue::makeObject(
+      mo->isAttached() ? mo->getParentSceneNode() : 0);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool MovableSI::ParentNode::doSetValue(void* target, const ParamValue& value) {
+  Ogre::MovableObject* mo = static_cast<const MovableSI*>(target)->getMovable();
+  Ogre::SceneNode* node = value.getObject<Ogre::SceneNode>();
+  if (!node) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 parent node");
+  if (mo->isAttached()) mo->detachFromParent();
+  node->attachObject(mo);
+  return true;
+}
+
 //------------------------------------------------------------------------------
 MovableSI::MovableSI(Ogre::MovableObject* obj)
     : StringInterface("movable", true), mMovable(obj) {
@@ -119,6 +280,21 @@ void LightSI::LightType::doSet(void* target, ArgHandler* handler) {
   light->setType(enumFromString<Ogre::Light::LightTypes>(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool LightSI::LightType::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  value = ParamValue::makeEnum(light->getType());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::LightType::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  light->setType(static_cast<Ogre::Light::LightTypes>(value.getEnum()));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string LightSI::Diffuse::doGet(const void* target) const {
   Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
@@ -127,9 +303,23 @@ std::string LightSI::Diffuse::doGet(const void* target) const {
 
 //------------------------------------------------------------------------------
 void LightSI::Diffuse::doSet(void* target, ArgHandler* handler) {
+  doSetValue(target,
+      makeColour3(Ogre::StringConverter::parseColourValue(handler->getValue())));
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::Diffuse::doGetValue(const void* target, ParamValue& value) const {
   Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
-  light->setDiffuseColour(
-      Ogre::StringConverter::parseColourValue(handler->getValue()));
+  value = makeColour3(light->getDiffuseColour());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::Diffuse::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  const Real* v = value.getReals(3, -1, 1);  // nreal3
+  light->setDiffuseColour(Ogre::ColourValue(v[0], v[1], v[2]));
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -140,9 +330,24 @@ std::string LightSI::Specular::doGet(const void* target) const {
 
 //------------------------------------------------------------------------------
 void LightSI::Specular::doSet(void* target, ArgHandler* handler) {
+  doSetValue(target,
+      makeColour3(Ogre::StringConverter::parseColourValue(handler->getValue())));
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::Specular::doGetValue(
+    const void* target, ParamValue& value) const {
   Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
-  light->setSpecularColour(
-      Ogre::StringConverter::parseColourValue(handler->getValue()));
+  value = makeColour3(light->getSpecularColour());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::Specular::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  const Real* v = value.getReals(3, -1, 1);  // nreal3
+  light->setSpecularColour(Ogre::ColourValue(v[0], v[1], v[2]));
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -157,6 +362,21 @@ void LightSI::Direction::doSet(void* target, ArgHandler* handler) {
   light->setDirection(Ogre::StringConverter::parseVector3(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool LightSI::Direction::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  value = makeVector3(light->getDirection());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::Direction::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  light->setDirection(Ogre::Vector3(value.getReals(3)));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string LightSI::SpotOuter::doGet(const void* target) const {
   Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
@@ -257,6 +477,21 @@ void LightSI::PowerScale::doSet(void* target, ArgHandler* handler) {
   light->setPowerScale(Ogre::StringConverter::parseReal(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool LightSI::PowerScale::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  value = ParamValue::makeReal(light->getPowerScale());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool LightSI::PowerScale::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
+  light->setPowerScale(value.getReal());
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string LightSI::ShadowFarDist::doGet(const void* target) const {
   Ogre::Light* light = static_cast<const LightSI*>(target)->getLight();
@@ -310,6 +545,21 @@ void CameraSI::Position::doSet(void* target, ArgHandler* handler) {
   camera->setPosition(Ogre::StringConverter::parseVector3(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool CameraSI::Position::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
+  value = makeVector3(camera->getPosition());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool CameraSI::Position::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
+  camera->setPosition(Ogre::Vector3(value.getReals(3)));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string CameraSI::PolygonMode::doGet(const void* target) const {
   Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
@@ -323,6 +573,21 @@ void CameraSI::PolygonMode::doSet(void* target, ArgHandler* handler) {
       enumFromString<Ogre::PolygonMode>(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool CameraSI::PolygonMode::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
+  value = ParamValue::makeEnum(camera->getPolygonMode());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool CameraSI::PolygonMode::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
+  camera->setPolygonMode(static_cast<Ogre::PolygonMode>(value.getEnum()));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string CameraSI::Direction::doGet(const void* target) const {
   Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
@@ -349,6 +614,22 @@ void CameraSI::Orientation::doSet(void* target, ArgHandler* handler) {
       Ogre::StringConverter::parseQuaternion(handler->getUniformValue()));
 }
 
+//------------------------------------------------------------------------------
+bool CameraSI::Orientation::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
+  value = makeQuaternion(camera->getOrientation());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool CameraSI::Orientation::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Camera* camera = static_cast<const CameraSI*>(target)->getCamera();
+  const Real* v = value.getReals(4);
+  camera->setOrientation(Ogre::Quaternion(v[0], v[1], v[2], v[3]));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 CameraSI::CameraSI(Ogre::Camera* camera) : MovableSI(camera) {
   setName(camera->getMovableType());
@@ -395,6 +676,20 @@ void NodeSI::Position::doSet(void* target, ArgHandler* handler) {
   node->setPosition(Ogre::StringConverter::parseVector3(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool NodeSI::Position::doGetValue(const void* target, ParamValue& value) const {
+  Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
+  value = makeVector3(node->getPosition());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool NodeSI::Position::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
+  node->setPosition(Ogre::Vector3(value.getReals(3)));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string NodeSI::Scale::doGet(const void* target) const {
   Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
@@ -407,6 +702,20 @@ void NodeSI::Scale::doSet(void* target, ArgHandler* handler) {
   node->setScale(Ogre::StringConverter::parseVector3(handler->getValue()));
 }
 
+//------------------------------------------------------------------------------
+bool NodeSI::Scale::doGetValue(const void* target, ParamValue& value) const {
+  Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
+  value = makeVector3(node->getScale());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool NodeSI::Scale::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
+  node->setScale(Ogre::Vector3(value.getReals(3)));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string NodeSI::Orientation::doGet(const void* target) const {
   Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
@@ -420,6 +729,22 @@ void NodeSI::Orientation::doSet(void* target, ArgHandler* handler) {
       Ogre::StringConverter::parseQuaternion(handler->getUniformValue()));
 }
 
+//------------------------------------------------------------------------------
+bool NodeSI::Orientation::doGetValue(
+    const void* target, ParamValue& value) const {
+  Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
+  value = makeQuaternion(node->getOrientation());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool NodeSI::Orientation::doSetValue(void* target, const ParamValue& value) {
+  Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
+  const Real* v = value.getReals(4);
+  node->setOrientation(Ogre::Quaternion(v[0], v[1], v[2], v[3]));
+  return true;
+}
+
 //------------------------------------------------------------------------------
 std::string NodeSI::Parent::doGet(const void* target) const {
   Ogre::Node* node = static_cast<const NodeSI*>(target)->getNode();
@@ -22,13 +22,26 @@ const std::string& AhDict::getParamAhName(const std::string& param) {
   return iter->second;
 }
 
+//------------------------------------------------------------------------------
+void AhDict::addParameter(const std::string& param) {
+  mParameters.push_back(param);
+}
+
 //------------------------------------------------------------------------------
 OgreSiWrapper::OgreSiWrapper(const std::string& name, Ogre::StringInterface* si)
     : StringInterface(name, true), mOgreSI(si), mAhDict(0) {}
 
+//------------------------------------------------------------------------------
+bool OgreSiWrapper::setParameter(
+    const std::string& name, const std::string& value) {
+  if (!mOgreSI->setParameter(name, value)) return false;
+  markChanged(name);
+  return true;
+}
+
 //------------------------------------------------------------------------------
 bool OgreSiWrapper::setParameter(const std::string& name, ArgHandler* handler) {
-  return mOgreSI->setParameter(name, handler->getValue());
+  return setParameter(name, handler->getValue());
 }
 
 //------------------------------------------------------------------------------
@@ -43,13 +56,9 @@ const std::string& OgreSiWrapper::getValueArgHandler(const std::string& name) {
 }
 
 //------------------------------------------------------------------------------
-StringVector OgreSiWrapper::getParameters(void) const {
-  auto l = mOgreSI->getParameters();
-  StringVector sv;
-  std::for_each(l.begin(), l.end(),
-      [&](Ogre::ParameterDef& def) -> void { sv.push_back(def.name); });
-
-  return sv;
+const StringVector& OgreSiWrapper::getParameters(void) const {
+  if (!mAhDict) PAC_EXCEPT(Exception::ERR_INVALID_STATE, "0 ahDict");
+  return mAhDict->getParameters();
 }
 
 //------------------------------------------------------------------------------
@@ -59,6 +68,12 @@ bool OgreSiWrapper::createaAhDict() {
   if (iter == msAhDictMap.end()) {
     mAhDict =
         &msAhDictMap.insert(std::make_pair(mName, AhDict())).first->second;
+    // ogre parameter dictionary is per class, so are the names
+    const Ogre::ParameterList& l = mOgreSI->getParameters();
+    std::for_each(l.begin(), l.end(),
+        [&](const Ogre::ParameterDef& def) -> void {
+          mAhDict->addParameter(def.name);
+        });
     return true;
   } else {
     mAhDict = &iter->second;
@@ -44,19 +44,26 @@ Ogre::SceneNode* OgreUtil::getSceneNodeById(
 //------------------------------------------------------------------------------
 Ogre::SceneNode* OgreUtil::getSceneNodeByIdNoThrow(
     Ogre::SceneManager* mgr, Ogre::IdType id) {
-  if (id != nid) {
-    // normal node
-    Ogre::SceneNode* node = mgr->getSceneNode(id);
-    if (node) return node;
-    // try dynamic root and static root node
-    Ogre::SceneNode* dynRoot = mgr->getRootSceneNode(Ogre::SCENE_DYNAMIC);
-    if (id == dynRoot->getId()) return dynRoot;
-    Ogre::SceneNode* staticRoot = mgr->getRootSceneNode(Ogre::SCENE_STATIC);
-    if (id == staticRoot->getId()) return staticRoot;
-  }
-  sgLogger.logMessage(
-      "can not find scene node for id:" + Ogre::StringConverter::toString(id),
-      SL_TRIVIAL);
+  Ogre::SceneNode* node = findSceneNodeById(mgr, id);
+  if (!node)
+    sgLogger.logMessage(
+        "can not find scene node for id:" + Ogre::StringConverter::toString(id),
+        SL_TRIVIAL);
+  return node;
+}
+
+//------------------------------------------------------------------------------
+Ogre::SceneNode* OgreUtil::findSceneNodeById(
+    Ogre::SceneManager* mgr, Ogre::IdType id) {
+  if (id == nid) return 0;
+  // normal node
+  Ogre::SceneNode* node = mgr->getSceneNode(id);
+  if (node) return node;
+  // try dynamic root and static root node
+  Ogre::SceneNode* dynRoot = mgr->getRootSceneNode(Ogre::SCENE_DYNAMIC);
+  if (id == dynRoot->getId()) return dynRoot;
+  Ogre::SceneNode* staticRoot = mgr->getRootSceneNode(Ogre::SCENE_STATIC);
+  if (id == staticRoot->getId()) return staticRoot;
   return 0;
 }
 
@@ -3,29 +3,92 @@
 #include "pacStringInterface.h"
 #include "pacException.h"
 #include "pacStringUtil.h"
+#include "pacSlabPool.h"
+#include "pacStdUtil.h"
+#include "pacParamWatch.h"
+#include <boost/regex.hpp>
+#include <numeric>
+#include <sstream>
 
 namespace pac {
 
+size_t AbsDir::msGeneration = 0;
+AbsDirSet AbsDir::msChangedDirs;
+AbsDirUtil::PathCache AbsDirUtil::msPathCache;
+size_t AbsDirUtil::msCacheGeneration = 0;
+
 //------------------------------------------------------------------------------
 AbsDir::AbsDir(const std::string& name, StringInterface* si /*= 0*/)
-    : mTemp(false), mParent(0), mStringInterface(si), mName(name) {
-  if (mStringInterface) mStringInterface->onCreateDir(this);
+    : mTemp(false),
+      mSortedDirty(false),
+      mParent(0),
+      mStringInterface(si),
+      mName(name),
+      mFullPath(name),
+      mChangeGeneration(0) {
+  if (mStringInterface) {
+    mStringInterface->setOwnerDir(this);
+    mStringInterface->onCreateDir(this);
+  }
 }
 
 //------------------------------------------------------------------------------
 AbsDir::~AbsDir() {
   sgConsole.deleteDir(this);
+  ++msGeneration;
 
+  if (mChangeGeneration != 0) msChangedDirs.erase(this);
+  if (ParamWatch::hasWatches()) ParamWatch::removeDir(this);
   if (mParent) mParent->removeChild(this);
-  // operator on copy
-  AbsDirs dirs(mChildren);
-  std::for_each(dirs.begin(), dirs.end(), [&](AbsDir* v) -> void { delete v; });
-  PacAssert(mChildren.size() == 0, "non 0 children after remove children");
-  // mChildren.clear();
+  destroyChildren(mChildren);
+  mChildren.clear();
+  mChildIndex.clear();
   if (mStringInterface && mStringInterface->getWrapper())
     delete mStringInterface;
 }
 
+//------------------------------------------------------------------------------
+void* AbsDir::operator new(size_t size) {
+  return size == sizeof(AbsDir) ? getPool().allocate() : ::operator new(size);
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::operator delete(void* p, size_t size) {
+  if (size == sizeof(AbsDir))
+    getPool().deallocate(p);
+  else
+    ::operator delete(p);
+}
+
+//------------------------------------------------------------------------------
+SlabPool& AbsDir::getPool() {
+  static SlabPool* pool = new SlabPool(sizeof(AbsDir), 512);
+  return *pool;
+}
+
+//------------------------------------------------------------------------------
+size_t AbsDir::getMemoryUsage(bool recursive /*= false*/) const {
+  // heap memory of string, 0 if it's stored in place
+  auto stringUsage = [&](const std::string& s) -> size_t {
+    const char* p = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    return p >= self && p < self + sizeof(s) ? 0 : s.capacity() + 1;
+  };
+
+  size_t bytes = sizeof(*this) + stringUsage(mName) + stringUsage(mFullPath) +
+                 (mChildren.capacity() + mSortedChildren.capacity()) *
+                     sizeof(AbsDir*);
+  if (!mChildIndex.empty())
+    bytes += mChildIndex.bucket_count() * sizeof(void*) +
+             mChildIndex.size() * (sizeof(ChildIndex::value_type) +
+                                      sizeof(void*) + sizeof(size_t));
+
+  if (recursive)
+    std::for_each(mChildren.begin(), mChildren.end(),
+        [&](AbsDir* v) -> void { bytes += v->getMemoryUsage(true); });
+  return bytes;
+}
+
 //------------------------------------------------------------------------------
 std::string AbsDir::getParameter(const std::string& name) {
   PacAssertS(mStringInterface != 0, "0 string interface at " + getName());
@@ -38,7 +101,7 @@ const std::string& AbsDir::getValueArgHandler(const std::string& name) {
 }
 
 //------------------------------------------------------------------------------
-StringVector AbsDir::getParameters() const {
+const StringVector& AbsDir::getParameters() const {
   static StringVector sv;
   if (!mStringInterface) return sv;
 
@@ -77,31 +140,25 @@ void AbsDir::addChild(AbsDir* dir, bool temp /*= true*/) {
   dir->setTemp(temp);
 
   mChildren.push_back(dir);
+  indexChild(dir);
   dir->setParent(this);
 }
 
 //------------------------------------------------------------------------------
 AbsDir* AbsDir::addUniqueChild(
     const std::string& name, StringInterface* si, bool temp /*= true*/) {
-  if (hasChild(name)) {
-    AbsDir* dir = getChildByName(name);
-
+  AbsDir* dir = findIndexedChild(name);
+  if (dir) {
     dir->setStringInterface(si);
     dir->setTemp(temp);
     return dir;
   }
 
-  AbsDir* dir = new AbsDir(name, si);
+  dir = new AbsDir(name, si);
   this->addChild(dir, temp);
   return dir;
 }
 
-//------------------------------------------------------------------------------
-std::string AbsDir::getFullPath() {
-  if (!mParent) return this->getName();
-  return mParent->getFullPath() + this->getName() + pac::delim;
-}
-
 //------------------------------------------------------------------------------
 AbsDir* AbsDir::getChildAt(size_t i) {
   if (i >= mChildren.size())
@@ -112,20 +169,61 @@ AbsDir* AbsDir::getChildAt(size_t i) {
 
 //------------------------------------------------------------------------------
 AbsDir* AbsDir::getChildByName(const std::string& name) {
-  AbsDirs::iterator iter = std::find_if(mChildren.begin(), mChildren.end(),
-      [&](AbsDirs::value_type& v) -> bool { return v->getName() == name; });
-
-  if (iter == mChildren.end())
+  AbsDir* dir = findChild(name);
+  if (!dir)
     PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, name + " not found at " + mName);
 
-  return *iter;
+  return dir;
+}
+
+//------------------------------------------------------------------------------
+AbsDir* AbsDir::findChild(const std::string& name) {
+  return findIndexedChild(name);
+}
+
+//------------------------------------------------------------------------------
+AbsDir* AbsDir::findIndexedChild(const std::string& name) {
+  ChildIndex::iterator iter = mChildIndex.find(&name);
+  return iter == mChildIndex.end() ? 0 : iter->second;
 }
 
 //------------------------------------------------------------------------------
 bool AbsDir::hasChild(const std::string& name) {
-  AbsDirs::iterator iter = std::find_if(mChildren.begin(), mChildren.end(),
-      [&](AbsDirs::value_type& v) -> bool { return v->getName() == name; });
-  return iter != mChildren.end();
+  return mChildIndex.find(&name) != mChildIndex.end();
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::findChildrenByPrefix(const std::string& prefix, AbsDirs& dirs) {
+  const AbsDirs& sorted = getSortedChildren();
+  AbsDirs::const_iterator iter = std::lower_bound(sorted.begin(), sorted.end(),
+      prefix, [&](AbsDir* v, const std::string& s) -> bool {
+        return v->getName() < s;
+      });
+  for (; iter != sorted.end() &&
+         (*iter)->getName().compare(0, prefix.size(), prefix) == 0;
+       ++iter)
+    dirs.push_back(*iter);
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::getChildNames(const std::string& prefix, StringVector& names) {
+  AbsDirs dirs;
+  findChildrenByPrefix(prefix, dirs);
+  std::for_each(dirs.begin(), dirs.end(),
+      [&](AbsDir* v) -> void { names.push_back(v->getName()); });
+}
+
+//------------------------------------------------------------------------------
+const AbsDirs& AbsDir::getSortedChildren() {
+  if (mSortedDirty) {
+    mSortedChildren = mChildren;
+    std::stable_sort(mSortedChildren.begin(), mSortedChildren.end(),
+        [&](AbsDir* lhs, AbsDir* rhs) -> bool {
+          return lhs->getName() < rhs->getName();
+        });
+    mSortedDirty = false;
+  }
+  return mSortedChildren;
 }
 
 //------------------------------------------------------------------------------
@@ -133,17 +231,18 @@ void AbsDir::removeChildAt(size_t i) {
   if (i >= mChildren.size())
     PAC_EXCEPT(
         Exception::ERR_INVALIDPARAMS, "overflow : " + StringUtil::toString(i));
+  AbsDir* dir = mChildren[i];
   mChildren.erase(mChildren.begin() + i);
+  unindexChild(dir);
 }
 
 //------------------------------------------------------------------------------
 void AbsDir::removeChildByName(const std::string& name) {
-  AbsDirs::iterator iter = std::find_if(mChildren.begin(), mChildren.end(),
-      [&](AbsDirs::value_type& v) -> bool { return v->getName() == name; });
-
-  if (iter == mChildren.end())
+  AbsDir* dir = findIndexedChild(name);
+  if (!dir)
     PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, name + " not found at " + mName);
-  mChildren.erase(iter);
+  mChildren.erase(std::find(mChildren.begin(), mChildren.end(), dir));
+  unindexChild(dir);
 }
 
 //------------------------------------------------------------------------------
@@ -153,17 +252,91 @@ void AbsDir::removeChild(AbsDir* dir) {
   if (iter == mChildren.end())
     PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, dir->getName() + " not found ");
   mChildren.erase(iter);
+  unindexChild(dir);
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::indexChild(AbsDir* dir) {
+  ++msGeneration;
+  // keep the 1st one if name duplicated
+  mChildIndex.insert(std::make_pair(&dir->getName(), dir));
+  mSortedDirty = true;
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::unindexChild(AbsDir* dir) {
+  ++msGeneration;
+  mSortedDirty = true;
+  ChildIndex::iterator iter = mChildIndex.find(&dir->getName());
+  if (iter == mChildIndex.end() || iter->second != dir) return;
+
+  // index next child of the same name if there has one
+  AbsDirs::iterator next = std::find_if(mChildren.begin(), mChildren.end(),
+      [&](AbsDir* v) -> bool {
+        return v != dir && v->getName() == dir->getName();
+      });
+  // key points to name of dir, it must be replaced too
+  mChildIndex.erase(iter);
+  if (next != mChildren.end())
+    mChildIndex.insert(std::make_pair(&(*next)->getName(), *next));
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::markChanged(const std::string& name, size_t generation) {
+  mChangeGeneration = generation;
+  msChangedDirs.insert(this);
+  if (ParamWatch::hasWatches()) ParamWatch::notify(this, name);
 }
 
 //------------------------------------------------------------------------------
 void AbsDir::serialize(
     std::ostream& os, bool recursive /*= true*/, size_t lvl /*= 0*/) {
-  if (mStringInterface) mStringInterface->serialize(os, lvl);
-
+  AbsDirs dirs;
+  SizetVector levels;
   if (recursive) {
-    size_t childLvl = ++lvl;
-    std::for_each(mChildren.begin(), mChildren.end(),
-        [&](AbsDir* v) -> void { v->serialize(os, recursive, childLvl); });
+    collectSubtree(dirs, &levels);
+  } else {
+    dirs.push_back(this);
+    levels.push_back(0);
+  }
+
+  size_t numChunks = StdUtil::getNumChunks(dirs.size(), 64);
+  StringVector buffers(numChunks);
+  StdUtil::parallelChunks(dirs.size(), numChunks,
+      [&](size_t chunk, size_t first, size_t last) -> void {
+        std::ostringstream ss;
+        for (size_t i = first; i < last; ++i)
+          dirs[i]->serializeSelf(ss, lvl + levels[i]);
+        buffers[chunk] = ss.str();
+      });
+
+  std::string out;
+  out.reserve(std::accumulate(buffers.begin(), buffers.end(), size_t(0),
+      [&](size_t n, const std::string& v) -> size_t { return n + v.size(); }));
+  std::for_each(buffers.begin(), buffers.end(),
+      [&](const std::string& v) -> void { out.append(v); });
+  os.write(out.data(), out.size());
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::serializeSelf(std::ostream& os, size_t lvl) {
+  os << std::string(lvl * 2, ' ') << mName << "\n";
+  if (mStringInterface) mStringInterface->serialize(os, lvl + 1);
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::collectSubtree(AbsDirs& dirs, SizetVector* levels /*= 0*/) {
+  // iterative pre order, stack holds (dir, level) in reverse child order
+  std::vector<std::pair<AbsDir*, size_t>> stack(1, std::make_pair(this, 0));
+  while (!stack.empty()) {
+    AbsDir* dir = stack.back().first;
+    size_t lvl = stack.back().second;
+    stack.pop_back();
+    dirs.push_back(dir);
+    if (levels) levels->push_back(lvl);
+    for (AbsDirs::reverse_iterator iter = dir->mChildren.rbegin();
+         iter != dir->mChildren.rend(); ++iter)
+      stack.push_back(std::make_pair(*iter, lvl + 1));
   }
 }
 
@@ -173,25 +346,137 @@ void AbsDir::cleanTempDirs() {
     delete this;
     return;
   }
+
+  // detach temp children in a single compaction pass
+  AbsDirs temps;
+  size_t numKept = 0;
+  for (size_t i = 0; i < mChildren.size(); ++i) {
+    if (mChildren[i]->getTemp())
+      temps.push_back(mChildren[i]);
+    else
+      mChildren[numKept++] = mChildren[i];
+  }
+
+  if (!temps.empty()) {
+    mChildren.resize(numKept);
+    mChildIndex.clear();
+    std::for_each(mChildren.begin(), mChildren.end(), [&](AbsDir* v) -> void {
+      mChildIndex.insert(std::make_pair(&v->getName(), v));
+    });
+    mSortedDirty = true;
+    ++msGeneration;
+    destroyChildren(temps);
+  }
+
   std::for_each(mChildren.begin(), mChildren.end(),
       [&](AbsDir* v) -> void { v->cleanTempDirs(); });
 }
 
+//------------------------------------------------------------------------------
+void AbsDir::destroyChildren(const AbsDirs& dirs) {
+  std::for_each(dirs.begin(), dirs.end(), [&](AbsDir* v) -> void {
+    // already detached, don't let it remove itself from this dir
+    v->mParent = 0;
+    delete v;
+  });
+}
+
 //------------------------------------------------------------------------------
 AbsDirs::iterator AbsDir::beginChildIter() { return mChildren.begin(); }
 
 //------------------------------------------------------------------------------
 AbsDirs::iterator AbsDir::endChildIter() { return mChildren.end(); }
 
+//------------------------------------------------------------------------------
+void AbsDir::setName(const std::string& v) {
+  if (!mParent) {
+    mName = v;
+    updateFullPath();
+    return;
+  }
+  mParent->unindexChild(this);
+  mName = v;
+  mParent->indexChild(this);
+  updateFullPath();
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::setParent(AbsDir* v) {
+  mParent = v;
+  updateFullPath();
+}
+
+//------------------------------------------------------------------------------
+void AbsDir::updateFullPath() {
+  if (mParent) {
+    mFullPath.reserve(mParent->mFullPath.size() + mName.size() + 1);
+    mFullPath.assign(mParent->mFullPath).append(mName).append(pac::delim);
+  } else {
+    mFullPath = mName;
+  }
+  std::for_each(mChildren.begin(), mChildren.end(),
+      [&](AbsDir* v) -> void { v->updateFullPath(); });
+}
+
 //------------------------------------------------------------------------------
 void AbsDir::setStringInterface(StringInterface* v) {
   AbsDirs dirs(mChildren);
   // clean children
   std::for_each(dirs.begin(), dirs.end(), [&](AbsDir* v) -> void { delete v; });
+  v->setOwnerDir(this);
   v->onCreateDir(this);
   mStringInterface = v;
 }
 
+//------------------------------------------------------------------------------
+bool ChildProvider::hasChild(const std::string& name) {
+  StringVector names;
+  getChildNames(names);
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+//------------------------------------------------------------------------------
+VirtualDir::VirtualDir(const std::string& name, ChildProvider* provider,
+    StringInterface* si /*= 0*/)
+    : AbsDir(name, si), mProvider(provider) {
+  PacAssertS(mProvider != 0, "0 child provider at " + name);
+}
+
+//------------------------------------------------------------------------------
+VirtualDir::~VirtualDir() { delete mProvider; }
+
+//------------------------------------------------------------------------------
+AbsDir* VirtualDir::findChild(const std::string& name) {
+  AbsDir* dir = findIndexedChild(name);
+  if (dir) return dir;
+
+  StringInterface* si = mProvider->createStringInterface(name);
+  if (!si) return 0;
+
+  dir = new AbsDir(name, si);
+  addChild(dir, true);
+  return dir;
+}
+
+//------------------------------------------------------------------------------
+bool VirtualDir::hasChild(const std::string& name) {
+  return findIndexedChild(name) || mProvider->hasChild(name);
+}
+
+//------------------------------------------------------------------------------
+void VirtualDir::getChildNames(const std::string& prefix, StringVector& names) {
+  StringVector sv;
+  mProvider->getChildNames(sv);
+  sv.erase(std::remove_if(sv.begin(), sv.end(),
+               [&](const std::string& v) -> bool {
+                 return v.compare(0, prefix.size(), prefix) != 0;
+               }),
+      sv.end());
+  std::sort(sv.begin(), sv.end());
+  sv.erase(std::unique(sv.begin(), sv.end()), sv.end());
+  names.insert(names.end(), sv.begin(), sv.end());
+}
+
 //------------------------------------------------------------------------------
 AbsDir* AbsDirUtil::findPath(const std::string& path, AbsDir* curDir /*=0*/) {
   if (path.find(" ") != std::string::npos) return 0;
@@ -200,10 +485,94 @@ AbsDir* AbsDirUtil::findPath(const std::string& path, AbsDir* curDir /*=0*/) {
 
   if (path.empty()) return curDir;
 
-  if (StringUtil::isAbsolutePath(path))
-    return findAbsolutePath(path);
-  else
-    return findRelativePath(path, curDir);
+  bool absolute = StringUtil::isAbsolutePath(path);
+  if (!absolute && !curDir)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 current dir");
+
+  if (msCacheGeneration != AbsDir::getGeneration() ||
+      msPathCache.size() >= 4096) {
+    msPathCache.clear();
+    msCacheGeneration = AbsDir::getGeneration();
+  }
+
+  PathKey key(absolute ? 0 : curDir, path);
+  PathCache::iterator iter = msPathCache.find(key);
+  if (iter != msPathCache.end()) return iter->second;
+
+  AbsDir* dir =
+      absolute ? findAbsolutePath(path) : findRelativePath(path, curDir);
+  if (dir) msPathCache.insert(std::make_pair(key, dir));
+  return dir;
+}
+
+//------------------------------------------------------------------------------
+size_t AbsDirUtil::PathKeyHash::operator()(const PathKey& key) const {
+  return std::hash<std::string>()(key.second) ^
+         (std::hash<AbsDir*>()(key.first) << 1);
+}
+
+//------------------------------------------------------------------------------
+void AbsDirUtil::findPathPattern(
+    const std::string& pattern, AbsDir* curDir, AbsDirs& dirs) {
+  if (pattern.empty() || pattern.find(" ") != std::string::npos) return;
+
+  std::string relPattern(pattern);
+  if (StringUtil::isAbsolutePath(pattern)) {
+    curDir = &sgRootDir;
+    relPattern = pattern.substr(1);
+  }
+  if (!curDir) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 current dir");
+
+  // match level by level, keep dirs of current level in tree order
+  AbsDirs level(1, curDir);
+  StringVector sv = StringUtil::split(relPattern, pac::delim);
+  for (size_t i = 0; i != sv.size() && !level.empty(); ++i) {
+    const std::string& component = sv[i];
+    if (component == ".") continue;
+
+    AbsDirs next;
+    std::for_each(level.begin(), level.end(), [&](AbsDir* dir) -> void {
+      if (component == "..") {
+        AbsDir* parent = dir->getParent();
+        if (parent && std::find(next.begin(), next.end(), parent) == next.end())
+          next.push_back(parent);
+        return;
+      }
+      // match names first, only matched children are materialized
+      StringVector names;
+      dir->getChildNames("", names);
+      std::for_each(names.begin(), names.end(),
+          [&](const std::string& name) -> void {
+            if (!StringUtil::match(name, component)) return;
+            AbsDir* child = dir->findChild(name);
+            if (child) next.push_back(child);
+          });
+    });
+    level.swap(next);
+  }
+  dirs.insert(dirs.end(), level.begin(), level.end());
+}
+
+//------------------------------------------------------------------------------
+void AbsDirUtil::findChildRegex(
+    const std::string& regex, AbsDir* curDir, AbsDirs& dirs) {
+  if (!curDir) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 current dir");
+
+  boost::regex re;
+  try {
+    re.assign(regex);
+  } catch (boost::regex_error& e) {
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        "invalid regex " + regex + " : " + e.what());
+  }
+
+  StringVector names;
+  curDir->getChildNames("", names);
+  std::for_each(names.begin(), names.end(), [&](const std::string& v) -> void {
+    if (!boost::regex_match(v, re)) return;
+    AbsDir* dir = curDir->findChild(v);
+    if (dir) dirs.push_back(dir);
+  });
 }
 
 //------------------------------------------------------------------------------
@@ -226,11 +595,7 @@ AbsDir* AbsDirUtil::findRelativePath(const std::string& path, AbsDir* curDir) {
       curDir = curDir->getParent();
       continue;
     }
-    try {
-      curDir = curDir->getChildByName(sv[i]);
-    } catch (ItemIdentityException e) {
-      return 0;
-    }
+    curDir = curDir->findChild(sv[i]);
   }
   return curDir;
 }
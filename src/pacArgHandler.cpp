@@ -119,12 +119,16 @@ Node* Branch::getLastNode() {
   return std::get<0>(*nodeValues.rbegin());
 }
 
+size_t ArgHandler::msNumCreated = 0;
+
 //------------------------------------------------------------------------------
 ArgHandler::ArgHandler(const std::string& name)
     : mArgHandlerType(AHT_PRIMITIVE),
       mPromptType(PT_PROMPTANDCOMPLETE),
       mNode(0),
-      mName(name) {}
+      mName(name) {
+  ++msNumCreated;
+}
 
 //------------------------------------------------------------------------------
 ArgHandler::ArgHandler(const ArgHandler& rhs)
@@ -134,6 +138,7 @@ ArgHandler::ArgHandler(const ArgHandler& rhs)
       mName(rhs.mName) {
   // set tree node to 0
   mNode = 0;
+  ++msNumCreated;
 }
 
 //------------------------------------------------------------------------------
@@ -675,6 +680,7 @@ bool TreeArgHandler::validate(const std::string& s) {
     return false;
   } else {
     branches.begin()->restoreBranch();
+    this->setValue(s);
     return true;
   }
 }
@@ -915,12 +921,20 @@ void ArgHandlerLib::init() {
 
   // iteral
   this->registerArgHandler(new LiteralArgHandler("regex"));
+  this->registerArgHandler(new LiteralArgHandler("glob"));
   this->registerArgHandler(new LiteralArgHandler("angleAxis"));
   this->registerArgHandler(new LiteralArgHandler("-"));
+  this->registerArgHandler(new LiteralArgHandler("name"));
+  this->registerArgHandler(new LiteralArgHandler("param"));
+  this->registerArgHandler(new LiteralArgHandler("since"));
+  this->registerArgHandler(new StringArgHandler(
+      "findOp", {"==", "!=", "<", "<=", ">", ">=", "~"}));
 
   this->registerArgHandler(new QuaternionArgHandler());
   this->registerArgHandler(new IdArgHandler());
   this->registerArgHandler(new RegexArgHandler());
+  this->registerArgHandler(new GlobArgHandler());
+  this->registerArgHandler(new RawArgHandler());
 
   this->registerArgHandler(new PathArgHandler());
   // arg lib is inited before command lib, moved to CommandLib::init()
@@ -1,29 +1,159 @@
 #include "pacCmdHistory.h"
 #include "pacStringUtil.h"
 #include "pacException.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstring>
 
 namespace pac {
 std::string CmdHistory::msBlank;
 
 //------------------------------------------------------------------------------
 CmdHistory::CmdHistory(size_t size /*= 100*/, bool rollOver /*= false*/)
-    : mRollOver(rollOver), mSearchIndex(-1), mTopIndex(size - 1) {
+    : mRollOver(rollOver),
+      mSearchIndex(-1),
+      mTopIndex(size - 1),
+      mIndexed(true),
+      mRegion(0) {
   mStack.resize(size);
 }
 
+//------------------------------------------------------------------------------
+CmdHistory::~CmdHistory() { delete mRegion; }
+
 //------------------------------------------------------------------------------
 void CmdHistory::push(const std::string& cmdLine) {
   std::string l(cmdLine);
   StringUtil::trim(l);
 
   if (l.empty()) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "empty cmdline!");
-  // do nothing if it's the same as last one
-  if (l == mStack[mTopIndex]) return;
+  if (!pushRolling(l)) return;
 
-  mTopIndex = getNextRollingIndex(mTopIndex);
-  mStack[mTopIndex] = l;
+  mPushed.push_back(l);
+  Entry e = {mPushed.back().data(), mPushed.back().size()};
+  if (mIndexed)
+    indexEntry(e);
+  else
+    mUnindexed.push_back(e);
 
-  resetRolling();
+  if (mFile.is_open()) mFile << l << '\n' << std::flush;
+}
+
+//------------------------------------------------------------------------------
+void CmdHistory::load(const std::string& path) {
+  if (mFile.is_open())
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE, "history file already loaded");
+
+  mFile.open(path.c_str(), std::ios::app | std::ios::binary);
+  if (!mFile)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "failed to open " + path);
+
+  std::ifstream ifs(path.c_str(), std::ios::ate | std::ios::binary);
+  if (ifs.tellg() > 0) {
+    using namespace boost::interprocess;
+    file_mapping mapping(path.c_str(), read_only);
+    // region stays valid after mapping is destroyed
+    mRegion = new mapped_region(mapping, read_only);
+  }
+
+  // lines pushed before load go after lines in file
+  mUniques.clear();
+  mSequence.clear();
+  mUniqueMap.clear();
+  mTrigrams.clear();
+  mUnindexed.clear();
+  std::for_each(mPushed.begin(), mPushed.end(), [&](const std::string& v)
+                                                    -> void {
+    Entry e = {v.data(), v.size()};
+    mUnindexed.push_back(e);
+    mFile << v << '\n';
+  });
+  mFile << std::flush;
+  mIndexed = false;
+
+  if (!mRegion) return;
+
+  // read last size() lines backward into rolling stack
+  const char* first = static_cast<const char*>(mRegion->get_address());
+  const char* last = first + mRegion->get_size();
+  StringVector lines;
+  while (last != first && lines.size() < mStack.size()) {
+    const char* lineLast = last;
+    if (*(lineLast - 1) == '\n') --lineLast;
+    const char* lineFirst = lineLast;
+    while (lineFirst != first && *(lineFirst - 1) != '\n') --lineFirst;
+    if (lineFirst != lineLast)
+      lines.push_back(std::string(lineFirst, lineLast));
+    last = lineFirst;
+  }
+  std::for_each(lines.rbegin(), lines.rend(),
+      [&](const std::string& v) -> void { pushRolling(v); });
+  // pushed lines are more recent
+  std::for_each(mPushed.begin(), mPushed.end(),
+      [&](const std::string& v) -> void { pushRolling(v); });
+}
+
+//------------------------------------------------------------------------------
+StringVector CmdHistory::search(const std::string& pattern,
+    bool prefix /*= false*/, size_t limit /*= -1*/) {
+  buildIndex();
+  StringVector sv;
+  if (limit == 0) return sv;
+
+  if (pattern.size() < 3) {
+    // no trigram, walk back from the most recent one until limit
+    for (size_t seq = mSequence.size(); seq-- > 0 && sv.size() < limit;) {
+      const Unique& u = mUniques[mSequence[seq]];
+      // skip older duplicates
+      if (u.lastSeq != seq || !matches(u.text, pattern, prefix)) continue;
+      sv.push_back(std::string(u.text.data, u.text.size));
+    }
+    return sv;
+  }
+
+  // every matched line contains all trigrams of pattern, so the shortest
+  // posting list is enough to find all candidates
+  const SizetVector* candidates = 0;
+  for (size_t i = 0; i + 3 <= pattern.size(); ++i) {
+    TrigramMap::const_iterator iter = mTrigrams.find(getTrigram(&pattern[i]));
+    if (iter == mTrigrams.end()) return sv;
+    if (!candidates || iter->second.size() < candidates->size())
+      candidates = &iter->second;
+  }
+
+  SizetVector ids;
+  std::for_each(candidates->begin(), candidates->end(), [&](size_t id)
+                                                            -> void {
+    if (matches(mUniques[id].text, pattern, prefix)) ids.push_back(id);
+  });
+  std::sort(ids.begin(), ids.end(), [&](size_t lhs, size_t rhs) -> bool {
+    return mUniques[lhs].lastSeq > mUniques[rhs].lastSeq;
+  });
+  if (ids.size() > limit) ids.resize(limit);
+
+  std::for_each(ids.begin(), ids.end(), [&](size_t id) -> void {
+    sv.push_back(std::string(mUniques[id].text.data, mUniques[id].text.size));
+  });
+  return sv;
+}
+
+//------------------------------------------------------------------------------
+std::string CmdHistory::reverseSearch(const std::string& pattern,
+    size_t skip /*= 0*/, bool prefix /*= false*/) {
+  StringVector&& sv = search(pattern, prefix, skip + 1);
+  return sv.size() > skip ? sv[skip] : msBlank;
+}
+
+//------------------------------------------------------------------------------
+size_t CmdHistory::getNumEntries() {
+  buildIndex();
+  return mSequence.size();
+}
+
+//------------------------------------------------------------------------------
+size_t CmdHistory::getNumUniqueEntries() {
+  buildIndex();
+  return mUniques.size();
 }
 
 //------------------------------------------------------------------------------
@@ -55,6 +185,96 @@ const std::string& CmdHistory::next() {
 //------------------------------------------------------------------------------
 void CmdHistory::resetRolling() { mSearchIndex = -1; }
 
+//------------------------------------------------------------------------------
+bool CmdHistory::pushRolling(const std::string& l) {
+  // do nothing if it's the same as last one
+  if (l == mStack[mTopIndex]) return false;
+
+  mTopIndex = getNextRollingIndex(mTopIndex);
+  mStack[mTopIndex] = l;
+
+  resetRolling();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool CmdHistory::Entry::operator==(const Entry& rhs) const {
+  return size == rhs.size && std::memcmp(data, rhs.data, size) == 0;
+}
+
+//------------------------------------------------------------------------------
+size_t CmdHistory::EntryHash::operator()(const Entry& e) const {
+  // fnv-1a
+  size_t h = 2166136261u;
+  for (size_t i = 0; i < e.size; ++i) {
+    h ^= static_cast<unsigned char>(e.data[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+//------------------------------------------------------------------------------
+void CmdHistory::buildIndex() {
+  if (mIndexed) return;
+  mIndexed = true;
+
+  if (mRegion) {
+    const char* first = static_cast<const char*>(mRegion->get_address());
+    const char* last = first + mRegion->get_size();
+    while (first != last) {
+      const char* lineLast = static_cast<const char*>(
+          std::memchr(first, '\n', last - first));
+      if (!lineLast) lineLast = last;
+      if (lineLast != first) {
+        Entry e = {first, static_cast<size_t>(lineLast - first)};
+        indexEntry(e);
+      }
+      first = lineLast == last ? last : lineLast + 1;
+    }
+  }
+
+  std::for_each(mUnindexed.begin(), mUnindexed.end(),
+      [&](const Entry& v) -> void { indexEntry(v); });
+  mUnindexed.clear();
+}
+
+//------------------------------------------------------------------------------
+void CmdHistory::indexEntry(const Entry& e) {
+  size_t seq = mSequence.size();
+  std::pair<UniqueMap::iterator, bool> res =
+      mUniqueMap.insert(std::make_pair(e, mUniques.size()));
+  size_t id = res.first->second;
+  mSequence.push_back(id);
+
+  if (!res.second) {
+    mUniques[id].lastSeq = seq;
+    return;
+  }
+
+  Unique u = {e, seq};
+  mUniques.push_back(u);
+  for (size_t i = 0; i + 3 <= e.size; ++i) {
+    SizetVector& ids = mTrigrams[getTrigram(e.data + i)];
+    if (ids.empty() || ids.back() != id) ids.push_back(id);
+  }
+}
+
+//------------------------------------------------------------------------------
+unsigned int CmdHistory::getTrigram(const char* s) {
+  return (static_cast<unsigned char>(s[0]) << 16) |
+         (static_cast<unsigned char>(s[1]) << 8) |
+         static_cast<unsigned char>(s[2]);
+}
+
+//------------------------------------------------------------------------------
+bool CmdHistory::matches(
+    const Entry& e, const std::string& pattern, bool prefix) {
+  if (e.size < pattern.size()) return false;
+  if (prefix) return std::memcmp(e.data, pattern.data(), pattern.size()) == 0;
+  return std::search(e.data, e.data + e.size, pattern.begin(), pattern.end()) !=
+         e.data + e.size;
+}
+
 //------------------------------------------------------------------------------
 size_t CmdHistory::getNextRollingIndex(size_t i) {
   return (i + mStack.size() + 1) % mStack.size();
@@ -0,0 +1,223 @@
+#include "pacStable.h"
+#include "pacCmdStats.h"
+#include "pacAbsDir.h"
+#include "pacArgHandler.h"
+#include "pacConsole.h"
+#include <cmath>
+
+namespace pac {
+
+CmdStatsRecord::Phase CmdStatsRecord::msLex(CP_LEX);
+CmdStatsRecord::Phase CmdStatsRecord::msClone(CP_CLONE);
+CmdStatsRecord::Phase CmdStatsRecord::msValidate(CP_VALIDATE);
+CmdStatsRecord::Phase CmdStatsRecord::msExecute(CP_EXECUTE);
+CmdStatsRecord::Phase CmdStatsRecord::msFormat(CP_FORMAT);
+CmdStatsRecord::Phase CmdStatsRecord::msPrompt(CP_PROMPT);
+CmdStatsRecord::Branches CmdStatsRecord::msBranches;
+CmdStatsRecord::NumHandlers CmdStatsRecord::msNumHandlers;
+CmdStats::Enabled CmdStats::msEnabledCmd;
+CmdStats::Reset CmdStats::msReset;
+bool CmdStats::msEnabled = false;
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::add(unsigned long long ns) {
+  int i = ns <= 1 ? 0 : static_cast<int>(4 * std::log2(ns));
+  ++mBuckets[std::min(i, NUM_BUCKETS - 1)];
+  ++mCount;
+  mMax = std::max(mMax, ns);
+}
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::reset() {
+  mCount = 0;
+  mMax = 0;
+  std::fill(mBuckets, mBuckets + NUM_BUCKETS, 0);
+}
+
+//------------------------------------------------------------------------------
+unsigned long long LatencyHistogram::getPercentile(double p) const {
+  if (mCount == 0) return 0;
+  // rank of sample, 1 based
+  size_t rank = std::max<size_t>(1, std::ceil(p * mCount));
+  size_t n = 0;
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    n += mBuckets[i];
+    if (n >= rank) {
+      unsigned long long upper = std::pow(2.0, (i + 1) / 4.0);
+      return std::min(upper, mMax);
+    }
+  }
+  return mMax;
+}
+
+//------------------------------------------------------------------------------
+std::string LatencyHistogram::toString() const {
+  return StringUtil::toString(mCount) + " " +
+         StringUtil::toString(getPercentile(0.5) / 1000.0) + " " +
+         StringUtil::toString(getPercentile(0.99) / 1000.0) + " " +
+         StringUtil::toString(mMax / 1000.0);
+}
+
+//------------------------------------------------------------------------------
+CmdStatsRecord::CmdStatsRecord() : StringInterface("cmdStatsRecord", false) {
+  if (createParamDict()) initParams();
+}
+
+//------------------------------------------------------------------------------
+void CmdStatsRecord::reset() {
+  std::for_each(mPhases, mPhases + CP_MAX,
+      [&](LatencyHistogram& v) -> void { v.reset(); });
+  mNumHandlers.reset();
+  mBranches.clear();
+}
+
+//------------------------------------------------------------------------------
+std::string CmdStatsRecord::getBranches() const {
+  std::string s;
+  std::for_each(mBranches.begin(), mBranches.end(),
+      [&](const std::map<std::string, size_t>::value_type& v) -> void {
+        if (!s.empty()) s += " ";
+        s += v.first + ":" + StringUtil::toString(v.second);
+      });
+  return s;
+}
+
+//------------------------------------------------------------------------------
+std::string CmdStatsRecord::Phase::doGet(const void* target) const {
+  const CmdStatsRecord* record = static_cast<const CmdStatsRecord*>(target);
+  return record->getHistogram(phase).toString();
+}
+
+//------------------------------------------------------------------------------
+std::string CmdStatsRecord::Branches::doGet(const void* target) const {
+  const CmdStatsRecord* record = static_cast<const CmdStatsRecord*>(target);
+  return record->getBranches();
+}
+
+//------------------------------------------------------------------------------
+std::string CmdStatsRecord::NumHandlers::doGet(const void* target) const {
+  const CmdStatsRecord* record = static_cast<const CmdStatsRecord*>(target);
+  const LatencyHistogram& h = record->getNumHandlers();
+  // it's count, not time
+  return StringUtil::toString(h.getCount()) + " " +
+         StringUtil::toString(
+             static_cast<unsigned long>(h.getPercentile(0.5))) +
+         " " + StringUtil::toString(
+                   static_cast<unsigned long>(h.getPercentile(0.99))) +
+         " " + StringUtil::toString(static_cast<unsigned long>(h.getMax()));
+}
+
+//------------------------------------------------------------------------------
+void CmdStatsRecord::initParams() {
+  ParamDictionary* dict = this->getParamDict();
+  dict->addParameter("lex", &msLex, "count p50 p99 max, in microseconds");
+  dict->addParameter("clone", &msClone);
+  dict->addParameter("validate", &msValidate);
+  dict->addParameter("execute", &msExecute);
+  dict->addParameter("format", &msFormat);
+  dict->addParameter("prompt", &msPrompt);
+  dict->addParameter("branches", &msBranches, "branch:count");
+  dict->addParameter("handlers", &msNumHandlers,
+      "arg handlers created per execute, count p50 p99 max");
+}
+
+//------------------------------------------------------------------------------
+CmdStats::CmdStats() : StringInterface("cmdStats", false), mDir(0) {
+  if (createParamDict()) initParams();
+}
+
+//------------------------------------------------------------------------------
+CmdStats::~CmdStats() {
+  std::for_each(mRecords.begin(), mRecords.end(),
+      [&](RecordMap::value_type& v) -> void { delete v.second; });
+}
+
+//------------------------------------------------------------------------------
+void CmdStats::reset() {
+  std::for_each(mRecords.begin(), mRecords.end(),
+      [&](RecordMap::value_type& v) -> void { v.second->reset(); });
+}
+
+//------------------------------------------------------------------------------
+CmdStatsRecord* CmdStats::getRecord(const std::string& cmd) {
+  RecordMap::iterator iter = mRecords.find(cmd);
+  if (iter != mRecords.end()) return iter->second;
+
+  CmdStatsRecord* record = new CmdStatsRecord();
+  mRecords.insert(std::make_pair(cmd, record));
+  if (mDir) mDir->addChild(new AbsDir(cmd, record), false);
+  return record;
+}
+
+//------------------------------------------------------------------------------
+void CmdStats::record(
+    const std::string& cmd, CmdPhase phase, unsigned long long ns) {
+  if (cmd.empty()) return;
+  getRecord(cmd)->getHistogram(phase).add(ns);
+}
+
+//------------------------------------------------------------------------------
+std::string CmdStats::Enabled::doGet(const void* target) const {
+  (void)target;
+  return StringUtil::toString(CmdStats::getEnabled());
+}
+
+//------------------------------------------------------------------------------
+void CmdStats::Enabled::doSet(void* target, ArgHandler* handler) {
+  (void)target;
+  CmdStats::setEnabled(StringUtil::parseBool(handler->getValue()));
+}
+
+//------------------------------------------------------------------------------
+bool CmdStats::Enabled::doGetValue(
+    const void* target, ParamValue& value) const {
+  (void)target;
+  value = ParamValue::makeBool(CmdStats::getEnabled());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool CmdStats::Enabled::doSetValue(void* target, const ParamValue& value) {
+  (void)target;
+  CmdStats::setEnabled(value.getBool());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::string CmdStats::Reset::doGet(const void* target) const {
+  (void)target;
+  return "false";
+}
+
+//------------------------------------------------------------------------------
+void CmdStats::Reset::doSet(void* target, ArgHandler* handler) {
+  CmdStats* stats = static_cast<CmdStats*>(target);
+  if (StringUtil::parseBool(handler->getValue())) stats->reset();
+}
+
+//------------------------------------------------------------------------------
+void CmdStats::initParams() {
+  ParamDictionary* dict = this->getParamDict();
+  dict->addParameter("enabled", &msEnabledCmd);
+  dict->addParameter("reset", &msReset, "set it to true to reset all stats");
+}
+
+//------------------------------------------------------------------------------
+CmdStatsTimer::CmdStatsTimer(CmdPhase phase, const std::string& cmd /*= ""*/)
+    : mRunning(CmdStats::getEnabled()), mPhase(phase) {
+  if (mRunning) {
+    mCmd = cmd;
+    mStart = std::chrono::steady_clock::now();
+  }
+}
+
+//------------------------------------------------------------------------------
+void CmdStatsTimer::stop() {
+  if (!mRunning) return;
+  mRunning = false;
+  unsigned long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - mStart).count();
+  CmdStats* stats = sgConsole.getCmdStats();
+  if (stats) stats->record(mCmd, mPhase, ns);
+}
+}
@@ -5,29 +5,33 @@
 #include "pacException.h"
 #include "pacLogger.h"
 #include "pacStringUtil.h"
+#include "pacCmdStats.h"
+#include "pacConsole.h"
 #include <boost/regex.hpp>
 
 namespace pac {
 
 //------------------------------------------------------------------------------
 Command::Command(const std::string& name, const std::string& ahName /* = ""*/)
-    : mName(name), mArgHandler(0) {
+    : mName(name), mAhName(ahName), mArgHandler(0) {
   boost::regex re("\\W");
   if (boost::regex_search(mName, re))
     PAC_EXCEPT(
         Exception::ERR_INVALIDPARAMS, "illegal character in\"" + mName + "\" ");
-
-  if (!ahName.empty()) mArgHandler = sgArgLib.createArgHandler(ahName);
 }
 
 //------------------------------------------------------------------------------
 Command::Command(const Command& rhs)
-    : mName(rhs.getName()), mArgHandler(rhs.mArgHandler->clone()) {}
+    : mName(rhs.getName()), mAhName(rhs.mAhName), mArgHandler(0) {
+  if (!rhs.mArgHandler)
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE,
+        "clone uninitialized command " + mName);
+  mArgHandler = rhs.mArgHandler->clone();
+}
 
 //------------------------------------------------------------------------------
 Command::~Command() {
-  if (mArgHandler == 0)
-    PAC_EXCEPT(Exception::ERR_INVALID_STATE, "0 arg handler");
+  // prototype might never be initialized
   delete mArgHandler;
   mArgHandler = 0;
 }
@@ -40,8 +44,25 @@ bool Command::execute() {
   // right trim
   std::string args = mArgs;
   StringUtil::trim(args, false, true);
-  if (mArgHandler->validate(args)) {
+
+  size_t numHandlers = ArgHandler::getNumCreated();
+  CmdStatsTimer validateTimer(CP_VALIDATE, mName);
+  bool valid = mArgHandler->validate(args);
+  validateTimer.stop();
+
+  if (valid) {
+    RaiiConsoleJson json(hasOption('j'));
+    CmdStatsTimer executeTimer(CP_EXECUTE, mName);
     bool res = this->doExecute();
+    executeTimer.stop();
+
+    if (CmdStats::getEnabled()) {
+      CmdStatsRecord* record = sgConsole.getCmdStats()->getRecord(mName);
+      if (mArgHandler->getArgHandlerType() == ArgHandler::AHT_TREE)
+        record->addBranch(
+            static_cast<TreeArgHandler*>(mArgHandler)->getMatchedBranch());
+      record->addNumHandlers(ArgHandler::getNumCreated() - numHandlers);
+    }
     return res;
   } else {
     outputErrMessage(args);
@@ -90,6 +111,10 @@ bool Command::hasOption(char c) {
 
 //------------------------------------------------------------------------------
 Command* Command::init() {
+  if (mArgHandler) return this;
+
+  sgLogger.logMessage("build arg handler of command " + mName, SL_TRIVIAL);
+  if (!mAhName.empty()) mArgHandler = sgArgLib.createArgHandler(mAhName);
   bool isHandlerCreated = mArgHandler;
   if (buildArgHandler()) {
     if (isHandlerCreated) {
@@ -123,7 +148,7 @@ CommandLib::~CommandLib() {
 Command* CommandLib::createCommand(const std::string& cmdName) {
   CmdMap::iterator iter = mCmdMap.find(cmdName);
   if (iter != mCmdMap.end()) {
-    return iter->second->clone();
+    return iter->second->init()->clone();
   } else {
     return 0;
   }
@@ -132,8 +157,6 @@ Command* CommandLib::createCommand(const std::string& cmdName) {
 //------------------------------------------------------------------------------
 void CommandLib::registerCommand(Command* cmdProto) {
   sgLogger.logMessage("register command " + cmdProto->getName());
-  // init it, let it build it's own arg handler
-  cmdProto->init();
   // check if it's already registerd
   CmdMap::iterator iter = std::find_if(mCmdMap.begin(), mCmdMap.end(),
       [&](CmdMap::value_type& v)
@@ -147,6 +170,16 @@ void CommandLib::registerCommand(Command* cmdProto) {
   }
 }
 
+//------------------------------------------------------------------------------
+void CommandLib::unregisterCommand(const std::string& cmdName) {
+  CmdMap::iterator iter = mCmdMap.find(cmdName);
+  if (iter == mCmdMap.end())
+    PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, cmdName + " not registered");
+  sgLogger.logMessage("unregister command " + cmdName);
+  delete iter->second;
+  mCmdMap.erase(iter);
+}
+
 //------------------------------------------------------------------------------
 void CommandLib::init() {
   // register intrinsic commands
@@ -156,6 +189,10 @@ void CommandLib::init() {
   registerCommand(new SetCmd());
   registerCommand(new GetCmd());
   registerCommand(new SzCmd());
+  registerCommand(new LoadCmd());
+  registerCommand(new SzMergeCmd());
+  registerCommand(new FindCmd());
+  registerCommand(new WatchCmd());
   registerCommand(new CtdCmd());
 }
 //------------------------------------------------------------------------------
@@ -2,10 +2,13 @@
 #include "pacConsole.h"
 #include "pacCommand.h"
 #include "pacArgHandler.h"
+#include "pacIntrinsicArgHandler.h"
 #include "pacConsoleUI.h"
 #include "pacAbsDir.h"
 #include "pacConsolePattern.h"
 #include "pacCmdHistory.h"
+#include "pacCmdStats.h"
+#include "pacOutputSink.h"
 #include "pacAbsDir.h"
 #include <boost/regex.hpp>
 
@@ -13,18 +16,33 @@ namespace pac {
 
 template <>
 Console* Singleton<Console>::msSingleton = 0;
+Console::Stream Console::msStreamCmd;
+Console::PageSize Console::msPageSizeCmd;
+Console::OutputLimit Console::msOutputLimitCmd;
 
 //------------------------------------------------------------------------------
 Console::Console(ConsoleUI* ui)
     : StringInterface("console", false),
       mIsBuffering(false),
+      mBatchDepth(0),
+      mJsonOutput(false),
+      mOutputCancelled(false),
+      mStreamMode(SM_BUFFER),
+      mPageSize(4096),
+      mNumDropped(0),
+      mOutputLimit(0),
+      mNumItems(0),
       mDir(0),
       mAlternateDir(0),
       mRootDir(0),
       mUi(ui),
       mPattern(0),
-      mCmdHistory(0) {
+      mCmdHistory(0),
+      mCmdStats(0),
+      mNumBuffered(0) {
   if (!ui) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 ui");
+  mLineBreak = ui->getLineBreak();
+  if (createParamDict()) initParams();
 }
 
 //------------------------------------------------------------------------------
@@ -34,6 +52,7 @@ Console::~Console() {
   delete &sgArgLib;
   delete &sgLogger;
   delete &sgRootDir;
+  delete mCmdStats;
   delete mCmdHistory;
 }
 
@@ -57,17 +76,23 @@ void Console::initCmdHistory() { mCmdHistory = new CmdHistory(); }
 
 //------------------------------------------------------------------------------
 void Console::initDir() {
-  //build root
-  mRootDir = new AbsDir(pac::delim);
+  //build root, console params live in it
+  mRootDir = new AbsDir(pac::delim, this);
   setCwd(&sgRootDir);
   AbsDir* uiDir = new AbsDir("consoleUi", mUi);
   mRootDir->addChild(uiDir, false);
+  mCmdStats = new CmdStats();
+  AbsDir* statsDir = new AbsDir("stats", mCmdStats);
+  mRootDir->addChild(statsDir, false);
+  mCmdStats->setDir(statsDir);
 }
 
 //------------------------------------------------------------------------------
 void Console::initArghandler() {
   new ArgHandlerLib();
   sgArgLib.init();
+  sgArgLib.registerArgHandler(
+      new StringArgHandler("streamMode", {"buffer", "page", "singleColumn"}));
 }
 
 //------------------------------------------------------------------------------
@@ -86,15 +111,29 @@ bool Console::execute(const std::string& cmdLine /*= ""*/) {
       "************************************************************");
   sgLogger.logMessage("executing command \"" + line + "\"");
 
+  RaiiConsoleBatch batch;
+
   fakeOutputDirAndCmd(line);
   mCmdHistory->push(line);
 
   mUi->setCmdLine("");
 
+  // timers are no-op and command name is never copied if stats is disabled
+  bool statsEnabled = CmdStats::getEnabled() && mCmdStats;
+  CmdStatsTimer lexTimer(CP_LEX);
   boost::regex reCmd2("^\\s*(\\w+)(\\s*.*)$");
   boost::smatch m;
   if (boost::regex_match(line, m, reCmd2)) {
+    if (statsEnabled) {
+      lexTimer.setCmd(m[1]);
+      mCmdStats->setCurrentCmd(m[1]);
+    }
+    lexTimer.stop();
+
+    CmdStatsTimer cloneTimer(CP_CLONE);
+    if (statsEnabled) cloneTimer.setCmd(m[1]);
     Command* cmd = sgCmdLib.createCommand(m[1]);
+    cloneTimer.stop();
     if (cmd) {
       cmd->setArgsAndOptions(m[2]);
       if (cmd->execute()) {
@@ -119,6 +158,7 @@ bool Console::execute(const std::string& cmdLine /*= ""*/) {
 void Console::prompt() {
   std::string&& cmdLine = mUi->getCmdLine();
   StringUtil::trim(cmdLine, true, false);
+  RaiiConsoleBatch batch;
   // fakeOutputDirAndCmd(cmdLine);
 
   boost::regex reCmd("^\\s*(\\w*)$");
@@ -131,6 +171,11 @@ void Console::prompt() {
     // extract command name, args and options
     boost::regex reCmd2("^\\s*(\\w+)(\\s*.*)$");
     if (boost::regex_match(cmdLine, m, reCmd2)) {
+      CmdStatsTimer promptTimer(CP_PROMPT);
+      if (CmdStats::getEnabled() && mCmdStats) {
+        promptTimer.setCmd(m[1]);
+        mCmdStats->setCurrentCmd(m[1]);
+      }
       Command* cmd = sgCmdLib.createCommand(m[1]);
       if (cmd) {
         cmd->setArgsAndOptions(m[2]);
@@ -145,23 +190,121 @@ void Console::prompt() {
 
 //------------------------------------------------------------------------------
 Console& Console::output(const std::string& s, int type /*= 1*/) {
-  if (type == 1 && mIsBuffering)
-    this->appendBuffer(s);
-  else
-    mUi->output(s, type);
+  return output({Fragment(s)}, type);
+}
+
+//------------------------------------------------------------------------------
+Console& Console::output(Fragments frags, int type /*= 1*/) {
+  return output(frags.begin(), frags.end(), type);
+}
+
+//------------------------------------------------------------------------------
+Console& Console::output(const Fragment* beg, const Fragment* end, int type) {
+  if (type == 1 && mIsBuffering) {
+    if (!acceptItem()) {
+      // dropped
+    } else if (mStreamMode == SM_SINGLE_COLUMN) {
+      this->appendBuffer(beg, end);
+      const std::string&& s = mPattern->applyLine(mBuffer[--mNumBuffered]);
+      writeSinks({Fragment(s)}, 1);
+    } else {
+      this->appendBuffer(beg, end);
+    }
+  } else {
+    writeSinks(beg, end, type);
+  }
 
   return *this;
 }
 
 //------------------------------------------------------------------------------
 Console& Console::outputLine(const std::string& s, int type /*= 1*/) {
+  return outputLine({Fragment(s)}, type);
+}
+
+//------------------------------------------------------------------------------
+Console& Console::outputLine(Fragments frags, int type /*= 1*/) {
   if (mIsBuffering)
     PAC_EXCEPT(
         Exception::ERR_INVALID_STATE, "Can not output line while buffering.");
-  mUi->outputLine(s, type);
+  // append line break to a reused fragment array, so it's a single write
+  mLineFrags.assign(frags.begin(), frags.end());
+  mLineFrags.push_back(Fragment(mLineBreak));
+  writeSinks(&mLineFrags.front(), &mLineFrags.back() + 1, type);
+  return *this;
+}
+
+//------------------------------------------------------------------------------
+Console& Console::outputRecord(Fields fields) {
+  if (fields.size() == 0) return *this;
+
+  if (!mJsonOutput) {
+    // value0 : value1 ...
+    mRecordFrags.clear();
+    std::for_each(fields.begin(), fields.end(), [&](const Field& v) -> void {
+      if (!mRecordFrags.empty()) mRecordFrags.push_back(Fragment(" : ", 3));
+      mRecordFrags.push_back(v.value);
+    });
+    return output(&mRecordFrags.front(), &mRecordFrags.back() + 1, 1);
+  }
+
+  if (mIsBuffering && !acceptItem()) return *this;
+
+  mJsonLine.clear();
+  mJsonLine.push_back('{');
+  std::for_each(fields.begin(), fields.end(), [&](const Field& v) -> void {
+    if (mJsonLine.size() > 1) mJsonLine.push_back(',');
+    StringUtil::appendJsonString(mJsonLine, v.name, strlen(v.name));
+    mJsonLine.push_back(':');
+    StringUtil::appendJsonString(mJsonLine, v.value.data, v.value.size);
+  });
+  mJsonLine.append("}\n");
+  writeSinks({Fragment(mJsonLine)}, 1);
   return *this;
 }
 
+//------------------------------------------------------------------------------
+void Console::addSink(OutputSink* sink) {
+  if (std::find(mSinks.begin(), mSinks.end(), sink) != mSinks.end())
+    PAC_EXCEPT(Exception::ERR_DUPLICATE_ITEM, "sink already added");
+  mSinks.push_back(sink);
+}
+
+//------------------------------------------------------------------------------
+void Console::removeSink(OutputSink* sink) {
+  std::vector<OutputSink*>::iterator iter =
+      std::find(mSinks.begin(), mSinks.end(), sink);
+  if (iter == mSinks.end())
+    PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, "sink not found");
+  mSinks.erase(iter);
+}
+
+//------------------------------------------------------------------------------
+void Console::flushOutput() { mUi->flush(); }
+
+//------------------------------------------------------------------------------
+void Console::beginBatch() {
+  if (mBatchDepth++ == 0) mUi->setBatching(true);
+}
+
+//------------------------------------------------------------------------------
+void Console::endBatch() {
+  PacAssert(mBatchDepth > 0, "It's wrong to end batch without begin it");
+  if (--mBatchDepth == 0) mUi->setBatching(false);
+}
+
+//------------------------------------------------------------------------------
+void Console::writeSinks(Fragments frags, int type) {
+  writeSinks(frags.begin(), frags.end(), type);
+}
+
+//------------------------------------------------------------------------------
+void Console::writeSinks(const Fragment* beg, const Fragment* end, int type) {
+  mUi->write(beg, end, type);
+  std::for_each(mSinks.begin(), mSinks.end(),
+      [&](OutputSink* v) -> void { v->write(beg, end, type); });
+}
+
 //------------------------------------------------------------------------------
 Console& Console::complete(const std::string& s) {
   mUi->complete(s);
@@ -172,7 +315,7 @@ Console& Console::complete(const std::string& s) {
 void Console::setCwd(AbsDir* dir) {
   mAlternateDir = mDir;
   mDir = dir;
-  std::string&& cwd = dir->getFullPath();
+  std::string cwd = dir->getFullPath();
   if (cwd.size() > 1) {
     // replace trailing / with " "
     *cwd.rbegin() = ' ';
@@ -189,20 +332,69 @@ void Console::startBuffer() {
   if (mIsBuffering)
     PAC_EXCEPT(
         Exception::ERR_INVALID_STATE, "It's wrong to start buffer twice");
-  if (!mBuffer.empty())
+  if (mNumBuffered != 0)
     PAC_EXCEPT(Exception::ERR_INVALID_STATE,
         "It'w wrong to start buffer when buffer is not empty");
   mIsBuffering = true;
+  mOutputCancelled = false;
+  mNumDropped = 0;
+  mNumItems = 0;
 }
 
 //------------------------------------------------------------------------------
 void Console::endBuffer() {
   PacAssert(mIsBuffering, "It'w wrong to end buffer without start it");
   mIsBuffering = false;
-  if (!mBuffer.empty())
-    mUi->output(mPattern->applyPattern(mBuffer.begin(), mBuffer.end()));
+  flushBuffer();
+  // don't hold memory of a whole listing of SM_BUFFER
+  if (mBuffer.size() > mPageSize) mBuffer.resize(mPageSize);
+  if (mOutputCancelled) {
+    outputLine({"output cancelled, ", StringUtil::toString(mNumDropped),
+        " items dropped"});
+    mOutputCancelled = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+void Console::cancelOutput() {
+  if (!mIsBuffering) return;
+  mOutputCancelled = true;
+  flushBuffer();
+}
+
+//------------------------------------------------------------------------------
+void Console::setPageSize(size_t v) {
+  if (v == 0) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 page size");
+  mPageSize = v;
+}
+
+//------------------------------------------------------------------------------
+void Console::flushBuffer() {
+  if (mNumBuffered == 0) return;
+
+  CmdStatsTimer timer(CP_FORMAT);
+  if (mCmdStats) timer.setCmd(mCmdStats->getCurrentCmd());
+  SVIter end = mBuffer.begin() + mNumBuffered;
+  const std::string&& s = mStreamMode == SM_BUFFER
+                              ? mPattern->applyPattern(mBuffer.begin(), end)
+                              : mPattern->applyPage(mBuffer.begin(), end);
+  timer.stop();
+  mNumBuffered = 0;
+  writeSinks({Fragment(s)}, 1);
+  // a page of an unfinished listing, show it now
+  if (mIsBuffering) flushOutput();
+}
 
-  mBuffer.clear();
+//------------------------------------------------------------------------------
+bool Console::acceptItem() {
+  if (!mOutputCancelled && mOutputLimit != 0 && mNumItems >= mOutputLimit)
+    cancelOutput();
+  if (mOutputCancelled) {
+    ++mNumDropped;
+    return false;
+  }
+  ++mNumItems;
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -213,6 +405,14 @@ void Console::rollCommand(bool backWard /*= true*/) {
     mUi->setCmdLine(mCmdHistory->next());
 }
 
+//------------------------------------------------------------------------------
+bool Console::searchCommand(const std::string& pattern, size_t skip /*= 0*/) {
+  const std::string&& cmdLine = mCmdHistory->reverseSearch(pattern, skip);
+  if (cmdLine.empty()) return false;
+  mUi->setCmdLine(cmdLine);
+  return true;
+}
+
 //------------------------------------------------------------------------------
 void Console::deleteDir(AbsDir* dir) {
   if (dir == mRootDir) {
@@ -225,7 +425,17 @@ void Console::deleteDir(AbsDir* dir) {
 }
 
 //------------------------------------------------------------------------------
-void Console::cleanTempDirs() { cleanTempDir(&sgRootDir); }
+void Console::cleanTempDirs() { sgRootDir.cleanTempDirs(); }
+
+//------------------------------------------------------------------------------
+void Console::setUi(ConsoleUI* v) {
+  if (mBatchDepth != 0) {
+    mUi->setBatching(false);
+    v->setBatching(true);
+  }
+  mUi = v;
+  mLineBreak = v->getLineBreak();
+}
 
 //------------------------------------------------------------------------------
 bool Console::isActive() { return mUi->getVisible(); }
@@ -251,24 +461,102 @@ void Console::promptCommandName(const std::string& cmdName) {
 
 //------------------------------------------------------------------------------
 void Console::fakeOutputDirAndCmd(const std::string& cmdLine) {
-  outputLine(mDir->getFullPath() + " " + cmdLine);
+  outputLine({mDir->getFullPath(), " ", cmdLine});
+}
+
+//------------------------------------------------------------------------------
+void Console::appendBuffer(const Fragment* beg, const Fragment* end) {
+  // reuse item strings, no allocation once they are big enough
+  if (mNumBuffered == mBuffer.size()) mBuffer.push_back(std::string());
+  std::string& item = mBuffer[mNumBuffered++];
+  item.clear();
+  for (; beg != end; ++beg) item.append(beg->data, beg->size);
+  if (mStreamMode == SM_PAGE && mNumBuffered >= mPageSize) flushBuffer();
 }
 
 //------------------------------------------------------------------------------
-void Console::appendBuffer(const std::string& v) { mBuffer.push_back(v); }
+void Console::initParams() {
+  ParamDictionary* dict = this->getParamDict();
+  dict->addParameter("streamMode", &msStreamCmd,
+      "buffer aligns output as a whole, page aligns every pageSize items, "
+      "singleColumn outputs every item as a line");
+  dict->addParameter("pageSize", &msPageSizeCmd, "items of a page");
+  dict->addParameter("outputLimit", &msOutputLimitCmd,
+      "cancel output after this many items, 0 is unlimited");
+}
 
 //------------------------------------------------------------------------------
-void Console::cleanTempDir(AbsDir* dir) {
-  if (dir->getTemp()) {
-    delete dir;
-    return;
+std::string Console::Stream::doGet(const void* target) const {
+  const Console* console = static_cast<const Console*>(
+      static_cast<const StringInterface*>(target));
+  switch (console->getStreamMode()) {
+    case SM_PAGE:
+      return "page";
+    case SM_SINGLE_COLUMN:
+      return "singleColumn";
+    default:
+      return "buffer";
   }
-  // operator on copy
-  AbsDirs dirs(dir->beginChildIter(), dir->endChildIter());
-  std::for_each(
-      dirs.begin(), dirs.end(), [&](AbsDir* d) -> void { cleanTempDir(d); });
 }
 
+//------------------------------------------------------------------------------
+void Console::Stream::doSet(void* target, ArgHandler* handler) {
+  Console* console =
+      static_cast<Console*>(static_cast<StringInterface*>(target));
+  const std::string& v = handler->getValue();
+  if (v == "page")
+    console->setStreamMode(SM_PAGE);
+  else if (v == "singleColumn")
+    console->setStreamMode(SM_SINGLE_COLUMN);
+  else
+    console->setStreamMode(SM_BUFFER);
+}
+
+//------------------------------------------------------------------------------
+std::string Console::PageSize::doGet(const void* target) const {
+  const Console* console = static_cast<const Console*>(
+      static_cast<const StringInterface*>(target));
+  return StringUtil::toString(console->getPageSize());
+}
+
+//------------------------------------------------------------------------------
+void Console::PageSize::doSet(void* target, ArgHandler* handler) {
+  Console* console =
+      static_cast<Console*>(static_cast<StringInterface*>(target));
+  console->setPageSize(
+      StringUtil::parsePrimitiveDecimal<unsigned int>(handler->getValue()));
+}
+
+//------------------------------------------------------------------------------
+std::string Console::OutputLimit::doGet(const void* target) const {
+  const Console* console = static_cast<const Console*>(
+      static_cast<const StringInterface*>(target));
+  return StringUtil::toString(console->getOutputLimit());
+}
+
+//------------------------------------------------------------------------------
+void Console::OutputLimit::doSet(void* target, ArgHandler* handler) {
+  Console* console =
+      static_cast<Console*>(static_cast<StringInterface*>(target));
+  console->setOutputLimit(
+      StringUtil::parsePrimitiveDecimal<unsigned int>(handler->getValue()));
+}
+
+//------------------------------------------------------------------------------
+RaiiConsoleJson::RaiiConsoleJson(bool enable)
+    : mPrevious(sgConsole.getJsonOutput()) {
+  if (enable) sgConsole.setJsonOutput(true);
+}
+
+//------------------------------------------------------------------------------
+RaiiConsoleJson::~RaiiConsoleJson() { sgConsole.setJsonOutput(mPrevious); }
+
+//------------------------------------------------------------------------------
+RaiiConsoleBatch::RaiiConsoleBatch() { sgConsole.beginBatch(); }
+
+//------------------------------------------------------------------------------
+RaiiConsoleBatch::~RaiiConsoleBatch() { sgConsole.endBatch(); }
+
 //------------------------------------------------------------------------------
 RaiiConsoleBuffer::RaiiConsoleBuffer() { sgConsole.startBuffer(); }
 
@@ -1,6 +1,7 @@
 #include "pacStable.h"
 #include "pacConsolePattern.h"
 #include <iostream>
+#include <cmath>
 #include "pacLogger.h"
 
 namespace pac {
@@ -27,17 +28,17 @@ std::string DefaultPattern::applyPattern(SVIter beg, SVIter end) {
   if (candidates.size() == 1 &&
       candidates[0] == 1)  // crazy case, 1 column only
   {
-    std::stringstream ss;
-    std::for_each(beg, end, [&](const std::string& v) -> void {
-      ss << StringUtil::toFixedLength(v, maxItemLen + mSpacing) << "\n";
-    });
-    return ss.str();
+    colWidthes.push_back(maxItemLen + mSpacing);
+    return layout(beg, end, colWidthes);
   } else  // find max column number
   {
+    RangeMax rm(beg, end);
     // loop from biggest one
     for (SizetVector::reverse_iterator iter = candidates.rbegin();
          iter != candidates.rend(); ++iter) {
-      if (valid(beg, end, *iter, colWidthes)) {
+      // every column is at least minItemLen + mSpacing wide
+      if (*iter * (minItemLen + mSpacing) > mTextWidth) continue;
+      if (valid(rm, *iter, colWidthes)) {
         numCol = *iter;
         break;
       }
@@ -47,27 +48,54 @@ std::string DefaultPattern::applyPattern(SVIter beg, SVIter end) {
       PAC_EXCEPT(Exception::ERR_INVALID_STATE, "found no valid column number");
     }
 
-    size_t numRow = ceil(static_cast<Real>(numItem) / numCol);
-    size_t numGrid = numRow * colWidthes.size();
+    return layout(beg, end, colWidthes);
+  }
+}
+
+//------------------------------------------------------------------------------
+std::string DefaultPattern::applyLine(const std::string& item) {
+  std::string res;
+  res.reserve(item.size() + mSpacing + 1);
+  res.append(item).append(mSpacing, ' ').push_back('\n');
+  return res;
+}
+
+//------------------------------------------------------------------------------
+std::string DefaultPattern::layout(
+    SVIter beg, SVIter end, const SizetVector& colWidthes) {
+  size_t numItem = end - beg;
+  size_t numCol = colWidthes.size();
+  size_t numRow = (numItem + numCol - 1) / numCol;
+
+  // every row ends with a single line break
+  size_t total = numRow;
+  for (size_t col = 0; col < numCol; ++col) {
+    size_t first = std::min(col * numRow, numItem);
+    size_t last = std::min(first + numRow, numItem);
+    total += (last - first) * colWidthes[col];
+  }
+  // items longer than column width (only in single column case) overflow
+  if (numCol == 1)
+    std::for_each(beg, end, [&](const std::string& v) -> void {
+      if (v.size() > colWidthes[0]) total += v.size() - colWidthes[0];
+    });
 
-    // output horizental. Becareful, item seq in mBuffers is vertical.
-    std::stringstream ss;
-    for (size_t i = 0; i != numGrid; ++i) {
-      size_t col = i % numCol;
-      size_t row = i / numCol;
+  std::string res;
+  res.reserve(total);
+  for (size_t row = 0; row < numRow; ++row) {
+    for (size_t col = 0; col < numCol; ++col) {
       size_t itemIndex = col * numRow + row;
-      if (itemIndex >= numItem) {
-        // meet empty grid in last col
-        ss << "\n";
-        continue;
-      }
-      ss << StringUtil::toFixedLength(*(beg + itemIndex), colWidthes[col]);
-      // line break at last column
-      if (col == numCol - 1) ss << "\n";
+      // meet empty grid in last col
+      if (itemIndex >= numItem) break;
+      const std::string& item = *(beg + itemIndex);
+      res.append(item);
+      if (item.size() < colWidthes[col])
+        res.append(colWidthes[col] - item.size(), ' ');
     }
-
-    return ss.str();
+    res.push_back('\n');
   }
+
+  return res;
 }
 
 //------------------------------------------------------------------------------
@@ -115,27 +143,40 @@ SizetVector DefaultPattern::getCandidateNumColumns(
 
 //------------------------------------------------------------------------------
 bool DefaultPattern::valid(
-    SVIter beg, SVIter end, size_t numCol, SizetVector& colWidthes) {
-  size_t numItem = end - beg;
-
-  size_t numRow = ceil(static_cast<Real>(numItem) / numCol);
+    const RangeMax& rm, size_t numCol, SizetVector& colWidthes) {
+  size_t numItem = rm.size();
+  size_t numRow = (numItem + numCol - 1) / numCol;
   size_t totalColWidth = 0;
-  size_t minItemLen, maxItemLen;
 
   colWidthes.clear();
-
-  // loop column, get length of each max item in column
   for (size_t i = 0; i < numCol; ++i) {
-    SVIter first = beg + numRow * i;
-    SVIter last = i == numCol - 1 ? end : first + numRow;
-
-    getMinMaxItemLen(first, last, minItemLen, maxItemLen);
-    size_t w = maxItemLen + mSpacing;
+    size_t first = numRow * i;
+    size_t last = i == numCol - 1 ? numItem : first + numRow;
+    size_t w = rm.query(first, last) + mSpacing;
     colWidthes.push_back(w);
     totalColWidth += w;
+    if (totalColWidth > mTextWidth) return false;
   }
 
-  // total length check
-  return totalColWidth <= mTextWidth;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+DefaultPattern::RangeMax::RangeMax(SVIter beg, SVIter end)
+    : mSize(end - beg), mTree(mSize * 2, 0) {
+  for (size_t i = 0; i < mSize; ++i)
+    mTree[mSize + i] = static_cast<unsigned int>((beg + i)->size());
+  for (size_t i = mSize; i-- > 1;)
+    mTree[i] = std::max(mTree[i * 2], mTree[i * 2 + 1]);
+}
+
+//------------------------------------------------------------------------------
+size_t DefaultPattern::RangeMax::query(size_t first, size_t last) const {
+  unsigned int res = 0;
+  for (first += mSize, last += mSize; first < last; first >>= 1, last >>= 1) {
+    if (first & 1) res = std::max(res, mTree[first++]);
+    if (last & 1) res = std::max(res, mTree[--last]);
+  }
+  return res;
 }
 }
@@ -1,17 +1,150 @@
 #include "pacConsoleUI.h"
 #include "pacStringUtil.h"
 #include "pacArgHandler.h"
+#include <limits>
 
 namespace pac {
 ConsoleUI::Alpha ConsoleUI::msAlpha;
+ConsoleUI::MaxLines ConsoleUI::msMaxLines;
 
 //------------------------------------------------------------------------------
-ConsoleUI::ConsoleUI() : StringInterface("consoleUi", false) {
+// number of utf8 code points
+static size_t getNumChars(const std::string& s) {
+  return std::count_if(s.begin(), s.end(),
+      [&](char c) -> bool { return (c & 0xC0) != 0x80; });
+}
+
+//------------------------------------------------------------------------------
+ConsoleUI::ConsoleUI()
+    : StringInterface("consoleUi", false),
+      mBatching(false),
+      mBatchType(1),
+      mNumBatchEvicted(0),
+      mMaxBatchSize(65536),
+      mLines(1000),
+      mFirstLine(0),
+      mNumLines(0),
+      mMaxLines(1000) {
   if (createParamDict()) {
     this->initParams();
   }
 }
 
+//------------------------------------------------------------------------------
+void ConsoleUI::output(const std::string& output, int type /*= 1*/) {
+  if (output.empty()) return;
+
+  size_t numEvicted = 0;
+  const char* beg = output.data();
+  const char* end = beg + output.size();
+  while (beg != end) {
+    const char* lineEnd = std::find(beg, end, '\n');
+    if (lineEnd != end) ++lineEnd;
+    numEvicted += pushLine(beg, lineEnd);
+    beg = lineEnd;
+  }
+
+  if (mBatching) {
+    if (!mBatch.empty() && type != mBatchType) flush();
+    mBatch.append(output);
+    mBatchType = type;
+    mNumBatchEvicted += numEvicted;
+    if (mBatch.size() >= mMaxBatchSize) flush();
+    return;
+  }
+
+  appendOutput(output, type);
+  if (numEvicted != 0) evictOutput(numEvicted);
+}
+
+//------------------------------------------------------------------------------
+void ConsoleUI::flush() {
+  if (!mBatch.empty()) appendOutput(mBatch, mBatchType);
+  if (mNumBatchEvicted != 0) evictOutput(mNumBatchEvicted);
+  mBatch.clear();
+  mNumBatchEvicted = 0;
+}
+
+//------------------------------------------------------------------------------
+void ConsoleUI::setBatching(bool v) {
+  if (mBatching && !v) flush();
+  mBatching = v;
+}
+
+//------------------------------------------------------------------------------
+void ConsoleUI::setMaxBatchSize(size_t v) {
+  if (v == 0) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 max batch size");
+  mMaxBatchSize = v;
+  if (mBatch.size() >= mMaxBatchSize) flush();
+}
+
+//------------------------------------------------------------------------------
+void ConsoleUI::write(const Fragment* beg, const Fragment* end, int type) {
+  mPending.clear();
+  for (; beg != end; ++beg) mPending.append(beg->data, beg->size);
+  output(mPending, type);
+}
+
+//------------------------------------------------------------------------------
+size_t ConsoleUI::pushLine(const char* beg, const char* end) {
+  if (mNumLines != 0) {
+    std::string& last = mLines[(mFirstLine + mNumLines - 1) % mMaxLines];
+    if (*last.rbegin() != '\n') {
+      last.append(beg, end);
+      return 0;
+    }
+  }
+
+  size_t numEvicted = 0;
+  if (mNumLines == mMaxLines) {
+    // reuse slot of the oldest line
+    numEvicted = getNumChars(mLines[mFirstLine]);
+    mFirstLine = (mFirstLine + 1) % mMaxLines;
+    --mNumLines;
+  }
+  mLines[(mFirstLine + mNumLines) % mMaxLines].assign(beg, end);
+  ++mNumLines;
+  return numEvicted;
+}
+
+//------------------------------------------------------------------------------
+void ConsoleUI::setMaxLines(size_t v) {
+  if (v == 0) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "0 max lines");
+
+  size_t numKept = std::min(v, mNumLines);
+  size_t numEvicted = 0;
+  for (size_t i = 0; i < mNumLines - numKept; ++i)
+    numEvicted += getNumChars(getLine(i));
+
+  StringVector lines(v);
+  for (size_t i = 0; i < numKept; ++i)
+    lines[i].swap(mLines[(mFirstLine + mNumLines - numKept + i) % mMaxLines]);
+
+  mLines.swap(lines);
+  mFirstLine = 0;
+  mNumLines = numKept;
+  mMaxLines = v;
+  if (mBatching)
+    mNumBatchEvicted += numEvicted;
+  else if (numEvicted != 0)
+    evictOutput(numEvicted);
+}
+
+//------------------------------------------------------------------------------
+const std::string& ConsoleUI::getLine(size_t i) const {
+  if (i >= mNumLines)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        "line index " + StringUtil::toString(i) + " out of range");
+  return mLines[(mFirstLine + i) % mMaxLines];
+}
+
+//------------------------------------------------------------------------------
+std::string ConsoleUI::getScrollback() const {
+  std::string res;
+  for (size_t i = 0; i < mNumLines; ++i) res.append(getLine(i));
+  return res;
+}
+
 //------------------------------------------------------------------------------
 void ConsoleUI::outputLine(const std::string& output, int type /*= 1*/) {
   return this->output(output + getLineBreak(), type);
@@ -34,13 +167,56 @@ std::string ConsoleUI::Alpha::doGet(const void* target) const {
 
 //------------------------------------------------------------------------------
 void ConsoleUI::Alpha::doSet(void* target, ArgHandler* handler) {
+  Real v = StringUtil::parsePrimitiveDecimal<Real>(handler->getValue());
+  doSetValue(target, ParamValue::makeReal(v));
+}
+
+//------------------------------------------------------------------------------
+bool ConsoleUI::Alpha::doGetValue(const void* target, ParamValue& value) const {
+  const ConsoleUI* ui = static_cast<const ConsoleUI*>(target);
+  value = ParamValue::makeReal(ui->getAlpha());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ConsoleUI::Alpha::doSetValue(void* target, const ParamValue& value) {
+  ConsoleUI* ui = static_cast<ConsoleUI*>(target);
+  ui->setAlpha(value.getReal(0, 1));  // npreal
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::string ConsoleUI::MaxLines::doGet(const void* target) const {
+  const ConsoleUI* ui = static_cast<const ConsoleUI*>(target);
+  return StringUtil::toString(ui->getMaxLines());
+}
+
+//------------------------------------------------------------------------------
+void ConsoleUI::MaxLines::doSet(void* target, ArgHandler* handler) {
+  unsigned int v =
+      StringUtil::parsePrimitiveDecimal<unsigned int>(handler->getValue());
+  doSetValue(target, ParamValue::makeInt(static_cast<int>(v)));
+}
+
+//------------------------------------------------------------------------------
+bool ConsoleUI::MaxLines::doGetValue(
+    const void* target, ParamValue& value) const {
+  const ConsoleUI* ui = static_cast<const ConsoleUI*>(target);
+  value = ParamValue::makeInt(ui->getMaxLines());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ConsoleUI::MaxLines::doSetValue(void* target, const ParamValue& value) {
   ConsoleUI* ui = static_cast<ConsoleUI*>(target);
-  ui->setAlpha(StringUtil::parsePrimitiveDecimal<Real>(handler->getValue()));
+  ui->setMaxLines(value.getInt(0, std::numeric_limits<int>::max()));
+  return true;
 }
 
 //------------------------------------------------------------------------------
 void ConsoleUI::initParams() {
   ParamDictionary* dict = this->getParamDict();
   dict->addParameter("alpha", &msAlpha);
+  dict->addParameter("maxLines", &msMaxLines, "max lines of scrollback");
 }
 }
@@ -84,12 +84,10 @@ void PathArgHandler::populatePromptBuffer(const std::string& s) {
   const std::string&& head = StringUtil::getHead(s);
   const std::string&& tail = StringUtil::getTail(s);
   AbsDir* headDir = AbsDirUtil::findPath(head, mDir);
-  std::for_each(headDir->beginChildIter(), headDir->endChildIter(),
-      [&](AbsDir* v) -> void {
-        if (tail.empty() || StringUtil::startsWith(v->getName(), tail)) {
-          appendPromptBuffer(v->getName());
-        }
-      });
+  StringVector names;
+  headDir->getChildNames(tail, names);
+  std::for_each(names.begin(), names.end(),
+      [&](const std::string& v) -> void { appendPromptBuffer(v); });
 }
 
 //------------------------------------------------------------------------------
@@ -134,7 +132,7 @@ bool CmdArgHandler::doValidate(const std::string& s) {
 
 //------------------------------------------------------------------------------
 ParamArgHandler::ParamArgHandler()
-    : StringArgHandler("param"), mDir(0), mPathNode(0) {}
+    : StringArgHandler("param"), mDir(0), mPathNode(0), mPatternNode(0) {}
 
 //------------------------------------------------------------------------------
 void ParamArgHandler::runtimeInit() {
@@ -144,19 +142,66 @@ void ParamArgHandler::runtimeInit() {
   }
   if (!mDir) PAC_EXCEPT(Exception::ERR_INVALID_STATE, "0 dir");
 
-  //@TODO, might cause problem if dir has tons of params
-  StringVector&& sv = mDir->getParameters();
-  this->insert(sv.begin(), sv.end());
+  if (mPatternNode) {
+    mPatternDirs.clear();
+    if (mPatternNode->getArgHandler()->getName() == "glob")
+      AbsDirUtil::findPathPattern(mPatternNode->getValue(), mDir, mPatternDirs);
+    else
+      AbsDirUtil::findChildRegex(mPatternNode->getValue(), mDir, mPatternDirs);
+  }
 }
 
 //------------------------------------------------------------------------------
-void ParamArgHandler::onLinked(Node* grandNode) {
-  if (!grandNode->isRoot()) {
-    if (grandNode->getArgHandler()->getName() == "path") mPathNode = grandNode;
-    if (mPathNode->isLoop())
-      PAC_EXCEPT(
-          Exception::ERR_INVALID_STATE, "unexcepted loop path before param");
+void ParamArgHandler::populatePromptBuffer(const std::string& s) {
+  if (!mDir) return;
+  if (!mPatternNode) {
+    const StringVector& sv = mDir->getParameters();
+    std::for_each(sv.begin(), sv.end(), [&](const std::string& v) -> void {
+      if (s.empty() || StringUtil::startsWith(v, s)) appendPromptBuffer(v);
+    });
+    return;
   }
+
+  // union of parameters of matched dirs
+  StringSet params;
+  std::for_each(mPatternDirs.begin(), mPatternDirs.end(),
+      [&](AbsDir* dir) -> void {
+        if (!dir->getStringInterface()) return;
+        const StringVector& sv = dir->getParameters();
+        std::for_each(sv.begin(), sv.end(), [&](const std::string& v) -> void {
+          if (s.empty() || StringUtil::startsWith(v, s)) params.insert(v);
+        });
+      });
+  std::for_each(params.begin(), params.end(),
+      [&](const std::string& v) -> void { appendPromptBuffer(v); });
+}
+
+//------------------------------------------------------------------------------
+bool ParamArgHandler::doValidate(const std::string& s) {
+  if (mPatternNode) {
+    return std::any_of(
+        mPatternDirs.begin(), mPatternDirs.end(), [&](AbsDir* dir) -> bool {
+          StringInterface* si = dir->getStringInterface();
+          return si && si->hasParameter(s);
+        });
+  }
+  StringInterface* si = mDir ? mDir->getStringInterface() : 0;
+  return si && si->hasParameter(s);
+}
+
+//------------------------------------------------------------------------------
+void ParamArgHandler::onLinked(Node* grandNode) {
+  if (grandNode->isRoot()) return;
+  const std::string& name = grandNode->getArgHandler()->getName();
+  if (name == "path")
+    mPathNode = grandNode;
+  else if (name == "glob" || name == "regex")
+    mPatternNode = grandNode;
+  else
+    return;
+  if (grandNode->isLoop())
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE,
+        "unexcepted loop " + name + " before param");
 }
 
 //------------------------------------------------------------------------------
@@ -227,6 +272,16 @@ void RegexArgHandler::populatePromptBuffer(const std::string& s) {
   appendPromptBuffer("pls input regular expression");
 }
 
+//------------------------------------------------------------------------------
+void GlobArgHandler::populatePromptBuffer(const std::string& s) {
+  appendPromptBuffer("pls input path pattern, * matches any characters");
+}
+
+//------------------------------------------------------------------------------
+void RawArgHandler::populatePromptBuffer(const std::string& s) {
+  appendPromptBuffer("pls input value");
+}
+
 //------------------------------------------------------------------------------
 ReadonlyArgHandler::ReadonlyArgHandler() : ArgHandler("readonly") {}
 
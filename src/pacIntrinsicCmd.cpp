@@ -5,6 +5,8 @@
 #include "pacArgHandler.h"
 #include "pacStdUtil.h"
 #include "pacIntrinsicArgHandler.h"
+#include "pacSnapshot.h"
+#include "pacParamWatch.h"
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
@@ -46,8 +48,12 @@ bool LsCmd::buildArgHandler() {
 //------------------------------------------------------------------------------
 void LsCmd::outputChildren(AbsDir* dir) {
   RaiiConsoleBuffer raii;
-  std::for_each(dir->beginChildIter(), dir->endChildIter(),
-      [&](AbsDir* childDir) -> void { sgConsole.output(childDir->getName()); });
+  StringVector names;
+  dir->getChildNames("", names);
+  for (StringVector::iterator iter = names.begin();
+       iter != names.end() && !sgConsole.isOutputCancelled(); ++iter) {
+    sgConsole.outputRecord({{"name", *iter}});
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -120,6 +126,24 @@ void SetCmd::outputErrMessage(const std::string& args) {
 bool SetCmd::doExecute() {
   TreeArgHandler* handler = static_cast<TreeArgHandler*>(mArgHandler);
   const std::string& branch = handler->getMatchedBranch();
+  if (branch == "2" || branch == "3") {
+    AbsDirs dirs;
+    AbsDir* curDir = sgConsole.getCwd();
+    if (branch == "2") {
+      // set ltl_glob glob param rawValue...
+      AbsDirUtil::findPathPattern(
+          handler->getMatchedNodeValue("glob"), curDir, dirs);
+    } else {
+      // set ltl_regex regex param rawValue...
+      AbsDirUtil::findChildRegex(
+          handler->getMatchedNodeValue("regex"), curDir, dirs);
+    }
+    Node* valueNode = handler->getMatchedNode("rawValue");
+    const std::string&& value = StringUtil::join(
+        valueNode->beginLoopValueIter(), valueNode->endLoopValueIter());
+    return bulkSet(dirs, handler->getMatchedNodeValue("param"), value);
+  }
+
   AbsDir* dir = 0;
   if (branch == "0") {
     // set param value
@@ -147,9 +171,70 @@ bool SetCmd::buildArgHandler() {
   Node* root = handler->getRoot();
   root->acn("param")->acn("value")->eb("0");
   root->acn("path")->acn("param")->acn("value")->eb("1");
+  root->acn("ltl_glob")
+      ->acn("glob")
+      ->acn("param")
+      ->acn("rawValue", "raw", Node::NT_LOOP)
+      ->eb("2");
+  root->acn("ltl_regex")
+      ->acn("regex")
+      ->acn("param")
+      ->acn("rawValue", "raw", Node::NT_LOOP)
+      ->eb("3");
   return true;
 }
 
+//------------------------------------------------------------------------------
+bool SetCmd::bulkSet(const AbsDirs& dirs, const std::string& param,
+    const std::string& value) {
+  // validated value handler of each value arg handler type, 0 if invalid
+  std::map<std::string, ArgHandler*> handlers;
+  size_t numSucceeded = 0;
+  StringVector failures;
+
+  std::for_each(dirs.begin(), dirs.end(), [&](AbsDir* dir) -> void {
+    try {
+      if (!dir->getStringInterface()) {
+        failures.push_back(dir->getFullPath() + " : 0 string interface");
+        return;
+      }
+      const std::string& ahName = dir->getValueArgHandler(param);
+      auto iter = handlers.find(ahName);
+      if (iter == handlers.end()) {
+        ArgHandler* valueHandler = sgArgLib.createArgHandler(ahName);
+        if (!valueHandler->validate(value)) {
+          delete valueHandler;
+          valueHandler = 0;
+        }
+        iter = handlers.insert(std::make_pair(ahName, valueHandler)).first;
+      }
+
+      if (!iter->second) {
+        failures.push_back(dir->getFullPath() + " : \"" + value +
+                           "\" is not a valid " + ahName);
+      } else if (dir->setParameter(param, iter->second)) {
+        ++numSucceeded;
+      } else {
+        failures.push_back(dir->getFullPath() + " : failed to set " + param);
+      }
+    } catch (Exception& e) {
+      failures.push_back(dir->getFullPath() + " : " + e.getDescription());
+    }
+  });
+
+  std::for_each(handlers.begin(), handlers.end(),
+      [&](std::map<std::string, ArgHandler*>::value_type& v)
+          -> void { delete v.second; });
+
+  std::for_each(failures.begin(), failures.end(),
+      [&](const std::string& v) -> void { sgConsole.outputLine(v); });
+  sgConsole.outputLine("set " + param + " of " +
+                       StringUtil::toString(dirs.size()) + " dirs : " +
+                       StringUtil::toString(numSucceeded) + " succeeded, " +
+                       StringUtil::toString(failures.size()) + " failed");
+  return failures.empty();
+}
+
 //------------------------------------------------------------------------------
 GetCmd::GetCmd() : Command("get") {}
 
@@ -225,15 +310,16 @@ void GetCmd::outputProperties(AbsDir* dir, const std::string& param /*= ""*/,
     const std::string& reExp /*= ""*/) {
   RaiiConsoleBuffer raii;
   if (!param.empty()) {
-    sgConsole.output(param + " : " + dir->getParameter(param));
+    sgConsole.outputRecord(
+        {{"name", param}, {"value", dir->getParameter(param)}});
     return;
   }
 
   boost::regex regex(reExp);
-  StringVector&& sv = dir->getParameters();
+  const StringVector& sv = dir->getParameters();
   std::for_each(sv.begin(), sv.end(), [&](const std::string& v) -> void {
     if (reExp.empty() || boost::regex_match(v, regex))
-      sgConsole.output(v + " : " + dir->getParameter(v));
+      sgConsole.outputRecord({{"name", v}, {"value", dir->getParameter(v)}});
   });
 }
 
@@ -247,21 +333,27 @@ bool SzCmd::doExecute() {
   bool recursive = !hasOption('R');
   const std::string& fileName = handler->getMatchedNodeValue("id");
 
-  boost::filesystem::ofstream ofs(fileName, std::fstream::trunc);
-  AbsDir* curDir = sgConsole.getCwd();
+  AbsDir* dir = sgConsole.getCwd();
 
-  if (branch == "0") {
-    // sz id
-    curDir->serialize(ofs, recursive);
-  } else if (branch == "1") {
+  if (branch == "1" || branch == "3") {
     // sz id path
-    AbsDir* dir =
-        AbsDirUtil::findPath(handler->getMatchedNodeValue("path"), curDir);
-    dir->serialize(ofs, recursive);
-  } else {
+    dir = AbsDirUtil::findPath(handler->getMatchedNodeValue("path"), dir);
+  } else if (branch != "0" && branch != "2") {
     PAC_EXCEPT(Exception::ERR_INVALID_STATE, "unknown branch");
   }
 
+  if (branch == "2" || branch == "3") {
+    // sz id [path] ltl_since base
+    std::string&& base = Snapshot::read(handler->getMatchedNodeValue("base"));
+    if (!Snapshot::saveSince(dir, fileName, base))
+      sgConsole.outputLine(
+          "base is from another session, full snapshot saved");
+  } else if (hasOption('b')) {
+    Snapshot::save(dir, fileName, recursive);
+  } else {
+    boost::filesystem::ofstream ofs(fileName, std::fstream::trunc);
+    dir->serialize(ofs, recursive);
+  }
   return true;
 }
 
@@ -269,9 +361,320 @@ bool SzCmd::doExecute() {
 bool SzCmd::buildArgHandler() {
   TreeArgHandler* handler = new TreeArgHandler(getDefAhName());
   Node* root = handler->getRoot();
-  root->eb("0");               // sz
-  root->acn("path")->eb("1");  // sz path
+  Node* idNode = root->acn("id", "raw");
+  idNode->eb("0");  // sz id
+  idNode->acn("ltl_since")->acn("base", "raw")->eb("2");
+  Node* pathNode = idNode->acn("path");
+  pathNode->eb("1");  // sz id path
+  pathNode->acn("ltl_since")->acn("base", "raw")->eb("3");
+  this->mArgHandler = handler;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+LoadCmd::LoadCmd() : Command("load") {}
+
+//------------------------------------------------------------------------------
+bool LoadCmd::doExecute() {
+  TreeArgHandler* handler = static_cast<TreeArgHandler*>(mArgHandler);
+  const std::string& branch = handler->getMatchedBranch();
+  AbsDir* dir = sgConsole.getCwd();
+
+  if (branch == "1") {
+    // load id path
+    dir = AbsDirUtil::findPath(handler->getMatchedNodeValue("path"), dir);
+  } else if (branch != "0") {
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE, "unknown branch");
+  }
+
+  size_t numApplied =
+      Snapshot::load(dir, handler->getMatchedNodeValue("id"));
+  sgConsole.outputLine(StringUtil::toString(numApplied) + " parameters loaded");
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool LoadCmd::buildArgHandler() {
+  TreeArgHandler* handler = new TreeArgHandler(getDefAhName());
+  Node* root = handler->getRoot();
+  Node* idNode = root->acn("id", "raw");
+  idNode->eb("0");               // load id
+  idNode->acn("path")->eb("1");  // load id path
   this->mArgHandler = handler;
   return true;
 }
+//------------------------------------------------------------------------------
+SzMergeCmd::SzMergeCmd() : Command("szmerge") {}
+
+//------------------------------------------------------------------------------
+bool SzMergeCmd::doExecute() {
+  TreeArgHandler* handler = static_cast<TreeArgHandler*>(mArgHandler);
+  StringVector snapshots;
+  snapshots.push_back(Snapshot::read(handler->getMatchedNodeValue("base")));
+  Node* incNode = handler->getMatchedNode("increment");
+  std::for_each(incNode->beginLoopValueIter(), incNode->endLoopValueIter(),
+      [&](const std::string& v) -> void {
+        snapshots.push_back(Snapshot::read(v));
+      });
+
+  std::string buf;
+  Snapshot::merge(snapshots, buf);
+
+  const std::string& fileName = handler->getMatchedNodeValue("id");
+  std::ofstream ofs(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if (!ofs.write(buf.data(), buf.size()))
+    PAC_EXCEPT(
+        Exception::ERR_CANNOT_WRITE_TO_FILE, "failed to write " + fileName);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool SzMergeCmd::buildArgHandler() {
+  TreeArgHandler* handler = new TreeArgHandler(getDefAhName());
+  handler->getRoot()
+      ->acn("id", "raw")
+      ->acn("base", "raw")
+      ->acn("increment", "raw", Node::NT_LOOP)
+      ->eb("0");
+  this->mArgHandler = handler;
+  return true;
+}
+
+/**
+ * Output change as a record, it's buffered as a single line command output if
+ * it's not in the middle of a command.
+ */
+class WatchOutputListener : public ParamListener {
+public:
+  virtual void onParameterChanged(
+      AbsDir* dir, const std::string& name, const std::string& value) {
+    if (sgConsole.isBuffering()) {
+      output(dir, name, value);
+    } else {
+      RaiiConsoleBuffer raii;
+      output(dir, name, value);
+    }
+  }
+
+private:
+  void output(AbsDir* dir, const std::string& name, const std::string& value) {
+    sgConsole.outputRecord(
+        {{"path", dir->getFullPath()}, {"param", name}, {"value", value}});
+  }
+};
+
+//------------------------------------------------------------------------------
+WatchCmd::WatchCmd() : Command("watch") {}
+
+//------------------------------------------------------------------------------
+ParamListener* WatchCmd::getListener() {
+  static WatchOutputListener listener;
+  return &listener;
+}
+
+//------------------------------------------------------------------------------
+bool WatchCmd::doExecute() {
+  TreeArgHandler* handler = static_cast<TreeArgHandler*>(mArgHandler);
+  const std::string& branch = handler->getMatchedBranch();
+  ParamListener* listener = getListener();
+
+  if (branch == "0") {
+    // watch
+    RaiiConsoleBuffer raii;
+    const ParamWatch::WatchMap& watches = ParamWatch::getWatches();
+    std::for_each(watches.begin(), watches.end(),
+        [&](const ParamWatch::WatchMap::value_type& v) -> void {
+          std::for_each(v.second.begin(), v.second.end(),
+              [&](const ParamWatch::Watch& watch) -> void {
+                if (watch.listener != listener) return;
+                sgConsole.outputRecord({{"path", v.first->getFullPath()},
+                    {"param", watch.name},
+                    {"sampled", watch.sampled ? "true" : "false"}});
+              });
+        });
+    return true;
+  } else if (branch != "1") {
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE, "unknown branch");
+  }
+
+  // watch path param
+  AbsDir* dir = AbsDirUtil::findPath(
+      handler->getMatchedNodeValue("path"), sgConsole.getCwd());
+  const std::string& param = handler->getMatchedNodeValue("param");
+  if (hasOption('d')) {
+    if (!ParamWatch::remove(dir, param, listener)) {
+      sgConsole.outputLine(dir->getFullPath() + param + " is not watched", 2);
+      return false;
+    }
+  } else {
+    ParamWatch::add(dir, param, listener, hasOption('s'));
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool WatchCmd::buildArgHandler() {
+  TreeArgHandler* handler = new TreeArgHandler(getDefAhName());
+  Node* root = handler->getRoot();
+  root->eb("0");
+  root->acn("path")->acn("param")->eb("1");
+  this->mArgHandler = handler;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+FindCmd::FindCmd() : Command("find") {}
+
+//------------------------------------------------------------------------------
+bool FindCmd::doExecute() {
+  TreeArgHandler* handler = static_cast<TreeArgHandler*>(mArgHandler);
+  mBranch = handler->getMatchedBranch();
+  mGlob = mBranch == "1" ? handler->getMatchedNodeValue("glob") : "";
+  mParam = mBranch == "2" || mBranch == "3"
+               ? handler->getMatchedNodeValue("param")
+               : "";
+  if (mBranch == "3") {
+    mOp = handler->getMatchedNodeValue("findOp");
+    Node* operandNode = handler->getMatchedNode("operand");
+    mOperand = StringUtil::join(
+        operandNode->beginLoopValueIter(), operandNode->endLoopValueIter());
+    if (mOp == "~") mRegex = boost::regex(mOperand);
+  }
+
+  AbsDir* dir = AbsDirUtil::findPath(
+      handler->getMatchedNodeValue("path"), sgConsole.getCwd());
+  if (!dir) {
+    sgConsole.outputLine("0 target dir", 2);
+    return false;
+  }
+
+  Items items;
+  collect(dir, items);
+
+  // match batch by batch, temporary string interfaces only live for a batch
+  static const size_t batchSize = 4096;
+  std::vector<StringInterface*> sis;
+  std::vector<char> matched;
+  StringVector values;
+  RaiiConsoleBuffer raii;
+  for (size_t first = 0;
+       first < items.size() && !sgConsole.isOutputCancelled();
+       first += batchSize) {
+    size_t last = std::min(first + batchSize, items.size());
+    size_t n = last - first;
+    sis.assign(n, 0);
+    matched.assign(n, 0);
+    values.assign(n, "");
+    // name only branches never read parameters
+    for (size_t i = 0; i < n && !mParam.empty(); ++i) {
+      const Item& item = items[first + i];
+      sis[i] = item.dir ? item.dir->getStringInterface()
+                        : item.vdir->getProvider()->createStringInterface(
+                              item.name);
+    }
+
+    StdUtil::parallelFor(n, 256, [&](size_t beg, size_t end) -> void {
+      for (size_t i = beg; i < end; ++i) {
+        try {
+          matched[i] = match(items[first + i].name, sis[i], values[i]);
+        } catch (std::exception& e) {
+          matched[i] = 0;
+        }
+      }
+    });
+
+    for (size_t i = 0; i < n && !sgConsole.isOutputCancelled(); ++i) {
+      if (!matched[i]) continue;
+      if (mParam.empty())
+        sgConsole.outputRecord({{"path", items[first + i].path}});
+      else
+        sgConsole.outputRecord(
+            {{"path", items[first + i].path}, {"value", values[i]}});
+    }
+
+    for (size_t i = 0; i < n; ++i)
+      if (!items[first + i].dir) delete sis[i];
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool FindCmd::buildArgHandler() {
+  TreeArgHandler* handler = new TreeArgHandler(getDefAhName());
+  this->mArgHandler = handler;
+  Node* pathNode = handler->getRoot()->acn("path");
+  pathNode->eb("0");
+  pathNode->acn("ltl_name")->acn("glob")->eb("1");
+  Node* paramNode = pathNode->acn("ltl_param")->acn("param", "id");
+  paramNode->eb("2");
+  paramNode->acn("findOp")
+      ->acn("operand", "raw", Node::NT_LOOP)
+      ->eb("3");
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void FindCmd::collect(AbsDir* dir, Items& items) {
+  Item item = {dir->getFullPath(), dir->getName(), dir, 0};
+  items.push_back(item);
+
+  VirtualDir* vdir = dynamic_cast<VirtualDir*>(dir);
+  if (!vdir) {
+    const AbsDirs& children = dir->getSortedChildren();
+    std::for_each(children.begin(), children.end(),
+        [&](AbsDir* v) -> void { collect(v, items); });
+    return;
+  }
+
+  StringVector names;
+  vdir->getChildNames("", names);
+  std::for_each(names.begin(), names.end(), [&](const std::string& v) -> void {
+    AbsDir* child = vdir->findIndexedChild(v);
+    if (child) {
+      collect(child, items);
+    } else {
+      Item item = {vdir->getFullPath() + v + pac::delim, v, 0, vdir};
+      items.push_back(item);
+    }
+  });
+}
+
+//------------------------------------------------------------------------------
+bool FindCmd::match(const std::string& name, StringInterface* si,
+    std::string& value) const {
+  if (mBranch == "0") return true;
+  if (mBranch == "1") return StringUtil::match(name, mGlob);
+
+  if (!si || !si->getParamDict() || !si->hasParameter(mParam))
+    return false;
+  if (mBranch == "2") {
+    value = si->getParameter(mParam);
+    return true;
+  }
+
+  value = si->getParameter(mParam);
+  return compare(value);
+}
+
+//------------------------------------------------------------------------------
+bool FindCmd::compare(const std::string& value) const {
+  if (mOp == "==") return value == mOperand;
+  if (mOp == "!=") return value != mOperand;
+  if (mOp == "~") return boost::regex_match(value, mRegex);
+
+  RealVector lhs, rhs;
+  if (!StringUtil::parseReals(value, lhs) ||
+      !StringUtil::parseReals(mOperand, rhs) || lhs.empty() ||
+      (rhs.size() != 1 && rhs.size() != lhs.size()))
+    return false;
+
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    Real l = lhs[i];
+    Real r = rhs.size() == 1 ? rhs[0] : rhs[i];
+    if ((mOp == "<" && !(l < r)) || (mOp == "<=" && !(l <= r)) ||
+        (mOp == ">" && !(l > r)) || (mOp == ">=" && !(l >= r)))
+      return false;
+  }
+  return true;
+}
 }
@@ -57,7 +57,8 @@ Logger::~Logger() {
 //------------------------------------------------------------------------------
 void Logger::logMessage(
     const std::string& msg, SeverityLevel lvl /*= SL_NORMAL*/) {
-  static src::severity_logger<SeverityLevel> lg;
+  // called from sink threads too
+  static src::severity_logger_mt<SeverityLevel> lg;
   BOOST_LOG_SEV(lg, lvl) << msg;
 }
 
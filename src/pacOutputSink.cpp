@@ -0,0 +1,93 @@
+#include "pacStable.h"
+#include "pacOutputSink.h"
+#include "pacLogger.h"
+
+namespace pac {
+
+//------------------------------------------------------------------------------
+FileSink::FileSink(const std::string& path, bool append /*= true*/)
+    : mFile(path.c_str(), append ? std::ios::app : std::ios::trunc) {
+  if (!mFile)
+    PAC_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "failed to open " + path);
+}
+
+//------------------------------------------------------------------------------
+void FileSink::write(const Fragment* beg, const Fragment* end, int type) {
+  for (; beg != end; ++beg) mFile.write(beg->data, beg->size);
+}
+
+//------------------------------------------------------------------------------
+void FileSink::flush() { mFile.flush(); }
+
+//------------------------------------------------------------------------------
+void CaptureSink::write(const Fragment* beg, const Fragment* end, int type) {
+  for (; beg != end; ++beg) mCaptured.append(beg->data, beg->size);
+}
+
+//------------------------------------------------------------------------------
+AsyncLogSink::AsyncLogSink()
+    : mStop(false),
+      mNumQueued(0),
+      mNumLogged(0),
+      mThread(&AsyncLogSink::run, this) {}
+
+//------------------------------------------------------------------------------
+AsyncLogSink::~AsyncLogSink() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mQueueCond.notify_one();
+  mThread.join();
+}
+
+//------------------------------------------------------------------------------
+void AsyncLogSink::write(const Fragment* beg, const Fragment* end, int type) {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t size = mQueue.size();
+    for (; beg != end; ++beg) mQueue.append(beg->data, beg->size);
+    // worker only wakes for queued bytes, flush would wait for nothing
+    if (mQueue.size() == size) return;
+    ++mNumQueued;
+  }
+  mQueueCond.notify_one();
+}
+
+//------------------------------------------------------------------------------
+void AsyncLogSink::flush() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  size_t numQueued = mNumQueued;
+  mLoggedCond.wait(lock, [&]() -> bool { return mNumLogged >= numQueued; });
+}
+
+//------------------------------------------------------------------------------
+void AsyncLogSink::run() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    mQueueCond.wait(lock, [&]() -> bool { return mStop || !mQueue.empty(); });
+    if (mQueue.empty() && mStop) break;
+
+    mQueue.swap(mBack);
+    size_t numQueued = mNumQueued;
+    lock.unlock();
+    logLines(mBack);
+    mBack.clear();
+    lock.lock();
+    mNumLogged = numQueued;
+    mLoggedCond.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+void AsyncLogSink::logLines(const std::string& text) {
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t pos = text.find('\n', start);
+    if (pos == std::string::npos) pos = text.size();
+    if (pos != start)
+      sgLogger.logMessage(text.substr(start, pos - start), SL_TRIVIAL);
+    start = pos + 1;
+  }
+}
+}
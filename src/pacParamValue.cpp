@@ -0,0 +1,165 @@
+#include "pacStable.h"
+#include "pacParamValue.h"
+#include "pacException.h"
+#include "pacStringUtil.h"
+
+namespace pac {
+
+//------------------------------------------------------------------------------
+ParamValue ParamValue::makeBool(bool v) {
+  ParamValue value;
+  value.mType = PVT_BOOL;
+  value.mData.b = v;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+ParamValue ParamValue::makeInt(int v) {
+  ParamValue value;
+  value.mType = PVT_INT;
+  value.mData.i = v;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+ParamValue ParamValue::makeReal(Real v) {
+  ParamValue value;
+  value.mType = PVT_REAL;
+  value.mData.reals[0] = v;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+ParamValue ParamValue::makeReals(const Real* v, size_t n) {
+  if (n > MAX_REALS)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        "too many reals : " + StringUtil::toString(n));
+  ParamValue value;
+  value.mType = PVT_REALS;
+  value.mNumReals = n;
+  std::copy(v, v + n, value.mData.reals);
+  return value;
+}
+
+//------------------------------------------------------------------------------
+ParamValue ParamValue::makeEnum(int v) {
+  ParamValue value;
+  value.mType = PVT_ENUM;
+  value.mData.i = v;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+ParamValue ParamValue::makeObject(void* v) {
+  ParamValue value;
+  value.mType = PVT_OBJECT;
+  value.mData.object = v;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+bool ParamValue::getBool() const {
+  checkType(PVT_BOOL);
+  return mData.b;
+}
+
+//------------------------------------------------------------------------------
+int ParamValue::getInt() const {
+  checkType(PVT_INT);
+  return mData.i;
+}
+
+//------------------------------------------------------------------------------
+Real ParamValue::getReal() const {
+  checkType(PVT_REAL);
+  return mData.reals[0];
+}
+
+//------------------------------------------------------------------------------
+const Real* ParamValue::getReals() const {
+  checkType(PVT_REALS);
+  return mData.reals;
+}
+
+//------------------------------------------------------------------------------
+const Real* ParamValue::getReals(size_t n) const {
+  checkType(PVT_REALS);
+  if (mNumReals != n)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        "expect " + StringUtil::toString(n) + " reals, got " +
+            StringUtil::toString(mNumReals));
+  return mData.reals;
+}
+
+//------------------------------------------------------------------------------
+int ParamValue::getInt(int min, int max) const {
+  checkRange(getInt(), min, max);
+  return mData.i;
+}
+
+//------------------------------------------------------------------------------
+Real ParamValue::getReal(Real min, Real max) const {
+  checkRange(getReal(), min, max);
+  return mData.reals[0];
+}
+
+//------------------------------------------------------------------------------
+const Real* ParamValue::getReals(size_t n, Real min, Real max) const {
+  const Real* reals = getReals(n);
+  std::for_each(reals, reals + n,
+      [&](Real v) -> void { checkRange(v, min, max); });
+  return reals;
+}
+
+//------------------------------------------------------------------------------
+int ParamValue::getEnum() const {
+  checkType(PVT_ENUM);
+  return mData.i;
+}
+
+//------------------------------------------------------------------------------
+void* ParamValue::getObject() const {
+  checkType(PVT_OBJECT);
+  return mData.object;
+}
+
+//------------------------------------------------------------------------------
+bool ParamValue::operator==(const ParamValue& rhs) const {
+  if (mType != rhs.mType) return false;
+  switch (mType) {
+    case PVT_NONE:
+      return true;
+    case PVT_BOOL:
+      return mData.b == rhs.mData.b;
+    case PVT_INT:
+    case PVT_ENUM:
+      return mData.i == rhs.mData.i;
+    case PVT_REAL:
+      return mData.reals[0] == rhs.mData.reals[0];
+    case PVT_REALS:
+      return mNumReals == rhs.mNumReals &&
+             std::equal(mData.reals, mData.reals + mNumReals, rhs.mData.reals);
+    case PVT_OBJECT:
+      return mData.object == rhs.mData.object;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void ParamValue::checkType(Type type) const {
+  if (mType != type)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        "expect value type " + StringUtil::toString(static_cast<int>(type)) +
+            ", got " + StringUtil::toString(static_cast<int>(mType)));
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void ParamValue::checkRange(T v, T min, T max) {
+  if (v < min || v > max)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        StringUtil::toString(v) + " is out of range [" +
+            StringUtil::toString(min) + ", " + StringUtil::toString(max) +
+            "]");
+}
+}
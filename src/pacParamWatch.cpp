@@ -0,0 +1,139 @@
+#include "pacStable.h"
+#include "pacParamWatch.h"
+#include "pacAbsDir.h"
+
+namespace pac {
+
+ParamWatch::WatchMap ParamWatch::msWatches;
+size_t ParamWatch::msNumSampled = 0;
+
+//------------------------------------------------------------------------------
+void QueuedParamListener::onParameterChanged(
+    AbsDir* dir, const std::string& name, const std::string& value) {
+  Event event = {dir, name, value};
+  mEvents.push_back(std::move(event));
+}
+
+//------------------------------------------------------------------------------
+void QueuedParamListener::drain(Events& events) {
+  events.clear();
+  events.swap(mEvents);
+}
+
+//------------------------------------------------------------------------------
+void ParamWatch::add(AbsDir* dir, const std::string& name,
+    ParamListener* listener, bool sampled /*= false*/) {
+  WatchMap::iterator iter = msWatches.find(dir);
+  if (iter != msWatches.end() &&
+      std::any_of(iter->second.begin(), iter->second.end(),
+          [&](const Watch& v) -> bool {
+            return v.listener == listener && v.name == name;
+          }))
+    return;
+
+  // read sampled value before anything is inserted, it might throw
+  Watch watch = {name, listener, sampled, ""};
+  if (sampled) watch.lastValue = dir->getParameter(name);
+  msWatches[dir].push_back(std::move(watch));
+  if (sampled) ++msNumSampled;
+}
+
+//------------------------------------------------------------------------------
+bool ParamWatch::remove(
+    AbsDir* dir, const std::string& name, ParamListener* listener) {
+  WatchMap::iterator iter = msWatches.find(dir);
+  if (iter == msWatches.end()) return false;
+
+  Watches& watches = iter->second;
+  auto watchIter = std::find_if(watches.begin(), watches.end(),
+      [&](const Watch& v) -> bool {
+        return v.listener == listener && v.name == name;
+      });
+  if (watchIter == watches.end()) return false;
+
+  if (watchIter->sampled) --msNumSampled;
+  watches.erase(watchIter);
+  if (watches.empty()) msWatches.erase(iter);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ParamWatch::removeListener(ParamListener* listener) {
+  for (WatchMap::iterator iter = msWatches.begin(); iter != msWatches.end();) {
+    Watches& watches = iter->second;
+    watches.erase(std::remove_if(watches.begin(), watches.end(),
+                      [&](const Watch& v) -> bool {
+                        if (v.listener != listener) return false;
+                        if (v.sampled) --msNumSampled;
+                        return true;
+                      }),
+        watches.end());
+    if (watches.empty())
+      iter = msWatches.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+//------------------------------------------------------------------------------
+void ParamWatch::removeDir(AbsDir* dir) {
+  WatchMap::iterator iter = msWatches.find(dir);
+  if (iter == msWatches.end()) return;
+
+  std::for_each(iter->second.begin(), iter->second.end(),
+      [&](const Watch& v) -> void {
+        if (v.sampled) --msNumSampled;
+      });
+  msWatches.erase(iter);
+}
+
+//------------------------------------------------------------------------------
+void ParamWatch::notify(AbsDir* dir, const std::string& name) {
+  WatchMap::iterator iter = msWatches.find(dir);
+  if (iter == msWatches.end()) return;
+
+  // copy listeners, they might add or remove watches
+  std::vector<ParamListener*> listeners;
+  std::string value;
+  std::for_each(iter->second.begin(), iter->second.end(),
+      [&](Watch& v) -> void {
+        if (v.name != name) return;
+        if (listeners.empty()) value = dir->getParameter(name);
+        if (v.sampled) v.lastValue = value;
+        listeners.push_back(v.listener);
+      });
+
+  std::for_each(listeners.begin(), listeners.end(),
+      [&](ParamListener* v) -> void {
+        v->onParameterChanged(dir, name, value);
+      });
+}
+
+//------------------------------------------------------------------------------
+size_t ParamWatch::sample() {
+  if (msNumSampled == 0) return 0;
+
+  // collect before notify, listeners might add or remove watches
+  QueuedParamListener::Events events;
+  std::vector<ParamListener*> listeners;
+  std::for_each(msWatches.begin(), msWatches.end(),
+      [&](WatchMap::value_type& v) -> void {
+        std::for_each(v.second.begin(), v.second.end(),
+            [&](Watch& watch) -> void {
+              if (!watch.sampled) return;
+              std::string&& value = v.first->getParameter(watch.name);
+              if (value == watch.lastValue) return;
+              watch.lastValue = value;
+              QueuedParamListener::Event event = {
+                  v.first, watch.name, std::move(value)};
+              events.push_back(std::move(event));
+              listeners.push_back(watch.listener);
+            });
+      });
+
+  for (size_t i = 0; i < events.size(); ++i)
+    listeners[i]->onParameterChanged(
+        events[i].dir, events[i].name, events[i].value);
+  return events.size();
+}
+}
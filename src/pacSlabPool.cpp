@@ -0,0 +1,53 @@
+#include "pacStable.h"
+#include "pacSlabPool.h"
+
+namespace pac {
+
+//------------------------------------------------------------------------------
+SlabPool::SlabPool(size_t blockSize, size_t blocksPerSlab /*= 256*/)
+    : mBlockSize(blockSize),
+      mBlocksPerSlab(std::max<size_t>(blocksPerSlab, 1)),
+      mNumAllocated(0),
+      mFreeList(0) {
+  const size_t align = sizeof(void*);
+  mBlockSize = std::max(mBlockSize, sizeof(FreeBlock));
+  mBlockSize = (mBlockSize + align - 1) / align * align;
+  mSlabSize = mBlockSize * mBlocksPerSlab;
+}
+
+//------------------------------------------------------------------------------
+SlabPool::~SlabPool() {
+  std::for_each(mSlabs.begin(), mSlabs.end(),
+      [&](char* v) -> void { ::operator delete(v); });
+}
+
+//------------------------------------------------------------------------------
+void* SlabPool::allocate() {
+  if (!mFreeList) addSlab();
+  FreeBlock* block = mFreeList;
+  mFreeList = block->next;
+  ++mNumAllocated;
+  return block;
+}
+
+//------------------------------------------------------------------------------
+void SlabPool::deallocate(void* p) {
+  if (!p) return;
+  FreeBlock* block = static_cast<FreeBlock*>(p);
+  block->next = mFreeList;
+  mFreeList = block;
+  --mNumAllocated;
+}
+
+//------------------------------------------------------------------------------
+void SlabPool::addSlab() {
+  char* slab = static_cast<char*>(::operator new(mSlabSize));
+  mSlabs.push_back(slab);
+  // link blocks in address order, so consecutive allocations are adjacent
+  for (size_t i = mBlocksPerSlab; i-- > 0;) {
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * mBlockSize);
+    block->next = mFreeList;
+    mFreeList = block;
+  }
+}
+}
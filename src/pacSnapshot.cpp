@@ -0,0 +1,442 @@
+#include "pacStable.h"
+#include "pacSnapshot.h"
+#include "pacAbsDir.h"
+#include "pacStringInterface.h"
+#include "pacException.h"
+#include "pacLogger.h"
+#include "pacStringUtil.h"
+#include "pacStdUtil.h"
+#include <fstream>
+#include <random>
+#include <chrono>
+
+namespace pac {
+
+static const char magic[] = {'P', 'A', 'C', 'S'};
+
+/**
+ * Bounds checked cursor over snapshot data, strings are not copied.
+ */
+class Snapshot::Reader {
+public:
+  Reader(const char* data, size_t size) : mCur(data), mEnd(data + size) {}
+
+  unsigned int readUint() {
+    require(4);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(mCur);
+    mCur += 4;
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<unsigned int>(p[3]) << 24;
+  }
+
+  void readString(const char*& data, size_t& size) {
+    size = readUint();
+    require(size);
+    data = mCur;
+    mCur += size;
+  }
+
+  void readBytes(const char*& data, size_t size) {
+    require(size);
+    data = mCur;
+    mCur += size;
+  }
+
+  bool atEnd() const { return mCur == mEnd; }
+
+  /**
+   * Throw if fewer than count * size bytes are left, used to check counts
+   * before anything is allocated for them.
+   */
+  void requireCount(size_t count, size_t size) {
+    if (static_cast<size_t>(mEnd - mCur) / size < count)
+      PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "truncated snapshot");
+  }
+
+private:
+  void require(size_t size) {
+    if (static_cast<size_t>(mEnd - mCur) < size)
+      PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "truncated snapshot");
+  }
+
+  const char* mCur;
+  const char* mEnd;
+};
+
+/**
+ * Parsed dir record, only used to merge snapshots.
+ */
+struct Snapshot::Record {
+  typedef std::pair<std::string, std::string> Param;
+
+  std::string name;
+  std::vector<Param> params;
+  std::vector<Record> children;
+};
+
+//------------------------------------------------------------------------------
+void Snapshot::write(AbsDir* dir, std::string& buf, bool recursive /*= true*/) {
+  writeHeader(buf, getSessionId(), StringInterface::getChangeGeneration());
+
+  AbsDirs dirs;
+  if (recursive)
+    dir->collectSubtree(dirs);
+  else
+    dirs.push_back(dir);
+
+  size_t numChunks = StdUtil::getNumChunks(dirs.size(), 64);
+  StringVector buffers(numChunks);
+  StdUtil::parallelChunks(dirs.size(), numChunks,
+      [&](size_t chunk, size_t first, size_t last) -> void {
+        for (size_t i = first; i < last; ++i)
+          writeDir(dirs[i], buffers[chunk],
+              recursive ? dirs[i]->getNumChildren() : 0);
+      });
+  std::for_each(buffers.begin(), buffers.end(),
+      [&](const std::string& v) -> void { buf.append(v); });
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::writeIncrement(
+    AbsDir* dir, std::string& buf, size_t baseGeneration) {
+  writeHeader(buf, getSessionId(), StringInterface::getChangeGeneration());
+
+  // group changed dirs under dir and their ancestors by parent
+  ChildMap childMap;
+  AbsDirSet visited;
+  const AbsDirSet& changedDirs = AbsDir::getChangedDirs();
+  std::for_each(changedDirs.begin(), changedDirs.end(),
+      [&](AbsDir* v) -> void {
+        if (v->getChangeGeneration() <= baseGeneration) return;
+        AbsDirs path;
+        AbsDir* d = v;
+        while (d && d != dir) {
+          path.push_back(d);
+          d = d->getParent();
+        }
+        if (!d) return;  // not in subtree
+
+        // ancestors are shared by many changed dirs, stop at 1st known one
+        for (AbsDirs::iterator iter = path.begin(); iter != path.end();
+             ++iter) {
+          if (!visited.insert(*iter).second) break;
+          childMap[(*iter)->getParent()].push_back(*iter);
+        }
+      });
+
+  std::for_each(childMap.begin(), childMap.end(),
+      [&](ChildMap::value_type& v) -> void {
+        std::sort(v.second.begin(), v.second.end(),
+            [&](AbsDir* lhs, AbsDir* rhs) -> bool {
+              return lhs->getName() < rhs->getName();
+            });
+      });
+
+  writeIncrementDir(dir, buf, childMap, baseGeneration);
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::save(
+    AbsDir* dir, const std::string& path, bool recursive /*= true*/) {
+  std::string buf;
+  write(dir, buf, recursive);
+
+  std::ofstream ofs(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!ofs.write(buf.data(), buf.size()))
+    PAC_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "failed to write " + path);
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::saveIncrement(
+    AbsDir* dir, const std::string& path, size_t baseGeneration) {
+  std::string buf;
+  writeIncrement(dir, buf, baseGeneration);
+
+  std::ofstream ofs(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!ofs.write(buf.data(), buf.size()))
+    PAC_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE, "failed to write " + path);
+}
+
+//------------------------------------------------------------------------------
+bool Snapshot::saveSince(
+    AbsDir* dir, const std::string& path, const std::string& base) {
+  Reader reader(base.data(), base.size());
+  unsigned long long session = 0;
+  size_t baseGeneration = readHeader(reader, &session);
+  // generation of another session says nothing about changes of this one
+  if (session != getSessionId()) {
+    save(dir, path);
+    return false;
+  }
+  saveIncrement(dir, path, baseGeneration);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+size_t Snapshot::apply(AbsDir* dir, const char* data, size_t size) {
+  Reader reader(data, size);
+  readHeader(reader);
+
+  size_t numApplied = applyDir(dir, reader);
+  if (!reader.atEnd())
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "trailing data in snapshot");
+  return numApplied;
+}
+
+//------------------------------------------------------------------------------
+size_t Snapshot::load(AbsDir* dir, const std::string& path) {
+  std::string&& buf = read(path);
+  return apply(dir, buf.data(), buf.size());
+}
+
+//------------------------------------------------------------------------------
+size_t Snapshot::getGeneration(const char* data, size_t size) {
+  Reader reader(data, size);
+  return readHeader(reader);
+}
+
+//------------------------------------------------------------------------------
+unsigned long long Snapshot::getSession(const char* data, size_t size) {
+  Reader reader(data, size);
+  unsigned long long session = 0;
+  readHeader(reader, &session);
+  return session;
+}
+
+//------------------------------------------------------------------------------
+unsigned long long Snapshot::getSessionId() {
+  static unsigned long long session = []() -> unsigned long long {
+    std::random_device rd;
+    unsigned long long v =
+        static_cast<unsigned long long>(rd()) << 32 ^ rd() ^
+        std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    return v ? v : 1;
+  }();
+  return session;
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::merge(const StringVector& snapshots, std::string& buf) {
+  if (snapshots.empty())
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "nothing to merge");
+
+  Record merged;
+  size_t generation = 0;
+  unsigned long long session = 0;
+  for (StringVector::const_iterator iter = snapshots.begin();
+       iter != snapshots.end(); ++iter) {
+    Reader reader(iter->data(), iter->size());
+    generation = readHeader(reader, &session);
+    Record record;
+    readRecord(record, reader);
+    if (!reader.atEnd())
+      PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "trailing data in snapshot");
+
+    if (iter == snapshots.begin())
+      merged.name = record.name;
+    overlayRecord(merged, record);
+  }
+
+  writeHeader(buf, session, generation);
+  writeRecord(merged, buf);
+}
+
+//------------------------------------------------------------------------------
+std::string Snapshot::read(const std::string& path) {
+  std::ifstream ifs(path.c_str(), std::ios::binary | std::ios::ate);
+  if (!ifs) PAC_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "failed to open " + path);
+
+  std::string buf(static_cast<size_t>(ifs.tellg()), 0);
+  ifs.seekg(0);
+  if (!ifs.read(&buf[0], buf.size()))
+    PAC_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "failed to read " + path);
+  return buf;
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::writeHeader(
+    std::string& buf, unsigned long long session, size_t generation) {
+  buf.append(magic, sizeof(magic));
+  appendUint(buf, version);
+  appendUint(buf, static_cast<unsigned int>(session & 0xffffffff));
+  appendUint(buf, static_cast<unsigned int>(session >> 32));
+  unsigned long long g = generation;
+  appendUint(buf, static_cast<unsigned int>(g & 0xffffffff));
+  appendUint(buf, static_cast<unsigned int>(g >> 32));
+}
+
+//------------------------------------------------------------------------------
+size_t Snapshot::readHeader(
+    Reader& reader, unsigned long long* session /*= 0*/) {
+  const char* header;
+  reader.readBytes(header, sizeof(magic));
+  if (!std::equal(magic, magic + sizeof(magic), header))
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "not a snapshot");
+  unsigned int v = reader.readUint();
+  if (v != version)
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+        "unknown snapshot version " + StringUtil::toString(v));
+
+  unsigned long long low = reader.readUint();
+  unsigned long long high = reader.readUint();
+  if (session) *session = high << 32 | low;
+
+  low = reader.readUint();
+  high = reader.readUint();
+  return static_cast<size_t>(high << 32 | low);
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::writeDir(AbsDir* dir, std::string& buf, size_t numChildren,
+    bool incremental /*= false*/, size_t baseGeneration /*= 0*/) {
+  appendString(buf, dir->getName());
+
+  StringInterface* si = dir->getStringInterface();
+  if (si) {
+    // reserve count, patch it after readonly params are skipped
+    size_t countPos = buf.size();
+    appendUint(buf, 0);
+    unsigned int numParams = 0;
+    const StringVector& params = si->getParameters();
+    std::for_each(params.begin(), params.end(),
+        [&](const std::string& v) -> void {
+          if (incremental && si->getParamGeneration(v) <= baseGeneration)
+            return;
+          if (si->getValueArgHandler(v) == "readonly") return;
+          appendString(buf, v);
+          appendString(buf, si->getParameter(v));
+          ++numParams;
+        });
+    std::string count;
+    appendUint(count, numParams);
+    buf.replace(countPos, 4, count);
+  } else {
+    appendUint(buf, 0);
+  }
+
+  appendUint(buf, numChildren);
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::writeIncrementDir(AbsDir* dir, std::string& buf,
+    const ChildMap& childMap, size_t baseGeneration) {
+  ChildMap::const_iterator iter = childMap.find(dir);
+  size_t numChildren = iter == childMap.end() ? 0 : iter->second.size();
+  writeDir(dir, buf, numChildren, true, baseGeneration);
+  if (numChildren == 0) return;
+
+  std::for_each(iter->second.begin(), iter->second.end(),
+      [&](AbsDir* v) -> void {
+        writeIncrementDir(v, buf, childMap, baseGeneration);
+      });
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::appendUint(std::string& buf, unsigned int v) {
+  char bytes[] = {static_cast<char>(v & 0xff),
+      static_cast<char>(v >> 8 & 0xff), static_cast<char>(v >> 16 & 0xff),
+      static_cast<char>(v >> 24 & 0xff)};
+  buf.append(bytes, 4);
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::appendString(std::string& buf, const std::string& s) {
+  appendUint(buf, s.size());
+  buf.append(s);
+}
+
+//------------------------------------------------------------------------------
+size_t Snapshot::applyDir(AbsDir* dir, Reader& reader) {
+  size_t numApplied = 0;
+  const char* data;
+  size_t size;
+  std::string name, value;
+
+  reader.readString(data, size);  // dir name, matched by parent
+  unsigned int numParams = reader.readUint();
+  for (unsigned int i = 0; i < numParams; ++i) {
+    reader.readString(data, size);
+    name.assign(data, size);
+    reader.readString(data, size);
+    value.assign(data, size);
+    if (!dir) continue;
+    try {
+      if (dir->setParameter(name, value)) ++numApplied;
+    } catch (Exception& e) {
+      sgLogger.logMessage("failed to load " + dir->getFullPath() + name +
+                              " : " + e.getDescription(),
+          SL_ERROR);
+    }
+  }
+
+  unsigned int numChildren = reader.readUint();
+  for (unsigned int i = 0; i < numChildren; ++i) {
+    // peek child name, the record is consumed by recursive call
+    Reader peek(reader);
+    peek.readString(data, size);
+    AbsDir* child = dir ? dir->findChild(std::string(data, size)) : 0;
+    numApplied += applyDir(child, reader);
+  }
+  return numApplied;
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::readRecord(Record& record, Reader& reader) {
+  const char* data;
+  size_t size;
+  reader.readString(data, size);
+  record.name.assign(data, size);
+
+  unsigned int numParams = reader.readUint();
+  reader.requireCount(numParams, 8);  // name and value length
+  record.params.resize(numParams);
+  for (unsigned int i = 0; i < numParams; ++i) {
+    reader.readString(data, size);
+    record.params[i].first.assign(data, size);
+    reader.readString(data, size);
+    record.params[i].second.assign(data, size);
+  }
+
+  unsigned int numChildren = reader.readUint();
+  reader.requireCount(numChildren, 12);  // name length and 2 counts
+  record.children.resize(numChildren);
+  for (unsigned int i = 0; i < numChildren; ++i)
+    readRecord(record.children[i], reader);
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::overlayRecord(Record& dst, Record& src) {
+  std::for_each(src.params.begin(), src.params.end(),
+      [&](Record::Param& v) -> void {
+        auto iter = std::find_if(dst.params.begin(), dst.params.end(),
+            [&](const Record::Param& p) -> bool { return p.first == v.first; });
+        if (iter == dst.params.end())
+          dst.params.push_back(std::move(v));
+        else
+          iter->second.swap(v.second);
+      });
+
+  std::for_each(src.children.begin(), src.children.end(),
+      [&](Record& v) -> void {
+        auto iter = std::find_if(dst.children.begin(), dst.children.end(),
+            [&](const Record& r) -> bool { return r.name == v.name; });
+        if (iter == dst.children.end())
+          dst.children.push_back(std::move(v));
+        else
+          overlayRecord(*iter, v);
+      });
+}
+
+//------------------------------------------------------------------------------
+void Snapshot::writeRecord(const Record& record, std::string& buf) {
+  appendString(buf, record.name);
+  appendUint(buf, record.params.size());
+  std::for_each(record.params.begin(), record.params.end(),
+      [&](const Record::Param& v) -> void {
+        appendString(buf, v.first);
+        appendString(buf, v.second);
+      });
+  appendUint(buf, record.children.size());
+  std::for_each(record.children.begin(), record.children.end(),
+      [&](const Record& v) -> void { writeRecord(v, buf); });
+}
+}
@@ -4,6 +4,20 @@
 namespace pac
 {
 
+size_t StdUtil::msMaxThreads = 0;
+
+//------------------------------------------------------------------------------
+size_t StdUtil::getNumChunks(size_t n, size_t grain) {
+  size_t numChunks = n / std::max<size_t>(grain, 1);
+  return std::max<size_t>(1, std::min(numChunks, getMaxThreads() * 4));
+}
+
+//------------------------------------------------------------------------------
+size_t StdUtil::getMaxThreads() {
+  if (msMaxThreads != 0) return msMaxThreads;
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
 //------------------------------------------------------------------------------
 std::string StdUtil::getIdenticalString(StringVector::iterator beg,
 		StringVector::iterator end)
@@ -2,16 +2,74 @@
 #include "pacArgHandler.h"
 #include "pacConsole.h"
 #include "pacException.h"
+#include "pacLogger.h"
+#include "pacAbsDir.h"
 
 namespace pac {
 
+//------------------------------------------------------------------------------
+ParamCmd::ParamCmd(const ParamCmd& rhs)
+    : ahName(rhs.ahName),
+      deferrable(rhs.deferrable),
+      mValidator(0),
+      mValidatorBusy(false) {}
+
+//------------------------------------------------------------------------------
+ParamCmd& ParamCmd::operator=(const ParamCmd& rhs) {
+  if (this == &rhs) return *this;
+  ahName = rhs.ahName;
+  deferrable = rhs.deferrable;
+  delete mValidator;
+  mValidator = 0;
+  return *this;
+}
+
+//------------------------------------------------------------------------------
+ParamCmd::~ParamCmd() { delete mValidator; }
+
 //------------------------------------------------------------------------------
 void ParamCmd::doSet(void* target, const std::string& val) {
-  ArgHandler* handler = sgArgLib.createArgHandler(ahName);
-  if (!handler->validate(val))
-    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, val + " is not a valid " + ahName);
-  doSet(target, handler);
-  delete handler;
+  ArgHandler* handler = acquireValidator();
+  try {
+    if (!handler->validate(val))
+      PAC_EXCEPT(
+          Exception::ERR_INVALIDPARAMS, val + " is not a valid " + ahName);
+    doSet(target, handler);
+  } catch (...) {
+    releaseValidator(handler);
+    throw;
+  }
+  releaseValidator(handler);
+}
+
+//------------------------------------------------------------------------------
+bool ParamCmd::validate(const std::string& val) {
+  ArgHandler* handler = acquireValidator();
+  bool valid = false;
+  try {
+    valid = handler->validate(val);
+  } catch (...) {
+    releaseValidator(handler);
+    throw;
+  }
+  releaseValidator(handler);
+  return valid;
+}
+
+//------------------------------------------------------------------------------
+ArgHandler* ParamCmd::acquireValidator() {
+  if (mValidatorBusy) return sgArgLib.createArgHandler(ahName);
+  if (!mValidator) mValidator = sgArgLib.createArgHandler(ahName);
+  mValidatorBusy = true;
+  return mValidator;
+}
+
+//------------------------------------------------------------------------------
+void ParamCmd::releaseValidator(ArgHandler* handler) {
+  if (handler == mValidator)
+    mValidatorBusy = false;
+  else
+    delete handler;
 }
 
 //------------------------------------------------------------------------------
@@ -28,40 +86,71 @@ void ReadonlyParamCmd::doSet(void* target, ArgHandler* handler) {
 }
 
 ParamDictionaryMap StringInterface::msDictionary;
+size_t StringInterface::msChangeGeneration = 0;
+bool StringInterface::msDeferred = false;
+StringInterface::PendingParams StringInterface::msPendingParams;
+StringInterface::PendingIndex StringInterface::msPendingIndex;
+std::mutex StringInterface::msPendingMutex;
+std::atomic<size_t> StringInterface::msNumPending(0);
 
 //------------------------------------------------------------------------------
 ParamCmd* ParamDictionary::getParamCmd(const std::string& name) {
-  ParamMap::iterator iter = mParamMap.find(name);
-  // if(iter == mParamMap.end())
-  // PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND,
-  // name + " not found ");
-
-  return iter == mParamMap.end() ? 0 : iter->second.paramCmd;
+  size_t index = findParamDef(name);
+  return index == static_cast<size_t>(-1) ? 0 : mParamDefs[index].paramCmd;
 }
 
 //------------------------------------------------------------------------------
 const ParamCmd* ParamDictionary::getParamCmd(const std::string& name) const {
-  ParamMap::const_iterator iter = mParamMap.find(name);
-  // if(iter == mParamMap.end())
-  // PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND,
-  // name + " not found ");
-
-  return iter == mParamMap.end() ? 0 : iter->second.paramCmd;
+  size_t index = findParamDef(name);
+  return index == static_cast<size_t>(-1) ? 0 : mParamDefs[index].paramCmd;
 }
 
 //------------------------------------------------------------------------------
 const std::string& ParamDictionary::getParamAhName(
     const std::string& name) const {
-  ParamMap::const_iterator iter = mParamMap.find(name);
-  if (iter == mParamMap.end())
+  size_t index = findParamDef(name);
+  if (index == static_cast<size_t>(-1))
     PAC_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, name + " not found ");
 
-  return iter->second.paramCmd->ahName;
+  return mParamDefs[index].paramCmd->ahName;
+}
+
+//------------------------------------------------------------------------------
+size_t ParamDictionary::findParamDef(const std::string& name) const {
+  if (mSlots.empty()) return -1;
+
+  size_t mask = mSlots.size() - 1;
+  for (size_t i = std::hash<std::string>()(name) & mask;; i = (i + 1) & mask) {
+    size_t slot = mSlots[i];
+    if (slot == 0) return -1;
+    if (mNames[slot - 1] == name) return slot - 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+void ParamDictionary::rehash() {
+  // at most half full
+  size_t size = 4;
+  while (size < mParamDefs.size() * 2) size <<= 1;
+  mSlots.assign(size, 0);
+
+  size_t mask = size - 1;
+  for (size_t index = 0; index < mNames.size(); ++index) {
+    size_t i = std::hash<std::string>()(mNames[index]) & mask;
+    while (mSlots[i] != 0) i = (i + 1) & mask;
+    mSlots[i] = index + 1;
+  }
 }
 
 //------------------------------------------------------------------------------
 void ParamDictionary::addParameter(const ParamDef& paramDef) {
-  mParamMap.insert(std::make_pair(paramDef.name, paramDef));
+  StringVector::iterator iter =
+      std::lower_bound(mNames.begin(), mNames.end(), paramDef.name);
+  if (iter != mNames.end() && *iter == paramDef.name) return;
+
+  mParamDefs.insert(mParamDefs.begin() + (iter - mNames.begin()), paramDef);
+  mNames.insert(iter, paramDef.name);
+  rehash();
 }
 
 //------------------------------------------------------------------------------
@@ -72,9 +161,7 @@ void ParamDictionary::addParameter(
 }
 
 //------------------------------------------------------------------------------
-StringVector ParamDictionary::getParameters(void) const {
-  return StdUtil::keys(mParamMap);
-}
+StringInterface::~StringInterface() { flushPendingParameters(true); }
 
 //------------------------------------------------------------------------------
 bool StringInterface::createParamDict() {
@@ -91,7 +178,7 @@ bool StringInterface::createParamDict() {
 }
 
 //-----------------------------------------------------------------------
-StringVector StringInterface::getParameters(void) const {
+const StringVector& StringInterface::getParameters(void) const {
   const ParamDictionary* dict = getParamDict();
   if(!dict){
     PAC_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, "0 dict");
@@ -99,6 +186,15 @@ StringVector StringInterface::getParameters(void) const {
   return dict->getParameters();
 }
 
+//------------------------------------------------------------------------------
+bool StringInterface::hasParameter(const std::string& name) const {
+  const ParamDictionary* dict = getParamDict();
+  if (dict) return dict->hasParameter(name);
+
+  const StringVector& params = getParameters();
+  return std::find(params.begin(), params.end(), name) != params.end();
+}
+
 //-----------------------------------------------------------------------
 bool StringInterface::setParameter(
     const std::string& name, const std::string& value) {
@@ -106,7 +202,16 @@ bool StringInterface::setParameter(
 
   ParamCmd* cmd = dict->getParamCmd(name);
   if (cmd) {
-    cmd->doSet(this, value);
+    if (msDeferred && cmd->deferrable) {
+      if (!cmd->validate(value))
+        PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+            value + " is not a valid " + cmd->ahName);
+      deferParameter(name, cmd, value);
+    } else {
+      flushPendingParameters();
+      cmd->doSet(this, value);
+    }
+    markChanged(name);
     return true;
   }
 
@@ -121,7 +226,13 @@ bool StringInterface::setParameter(
 
   ParamCmd* cmd = dict->getParamCmd(name);
   if (cmd) {
-    cmd->doSet(this, handler);
+    if (msDeferred && cmd->deferrable)
+      deferParameter(name, cmd, handler->getValue());
+    else {
+      flushPendingParameters();
+      cmd->doSet(this, handler);
+    }
+    markChanged(name);
     return true;
   }
 
@@ -129,6 +240,43 @@ bool StringInterface::setParameter(
   return false;
 }
 
+//------------------------------------------------------------------------------
+bool StringInterface::setValue(
+    const std::string& name, const ParamValue& value) {
+  ParamDictionary* dict = getParamDict();
+  ParamCmd* cmd = dict ? dict->getParamCmd(name) : 0;
+  if (!cmd) return false;
+
+  if (msDeferred && cmd->deferrable) {
+    deferValue(name, cmd, value);
+  } else {
+    flushPendingParameters();
+    if (!cmd->doSetValue(this, value)) return false;
+  }
+  markChanged(name);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool StringInterface::getValue(
+    const std::string& name, ParamValue& value) const {
+  const ParamDictionary* dict = getParamDict();
+  const ParamCmd* cmd = dict ? dict->getParamCmd(name) : 0;
+  if (!cmd) return false;
+
+  if (msNumPending.load() != 0) {
+    std::lock_guard<std::mutex> lock(msPendingMutex);
+    PendingIndex::const_iterator iter =
+        msPendingIndex.find(std::make_pair(this, name));
+    if (iter != msPendingIndex.end() &&
+        msPendingParams[iter->second].isTyped()) {
+      value = msPendingParams[iter->second].typedValue;
+      return true;
+    }
+  }
+  return cmd->doGetValue(this, value);
+}
+
 //-----------------------------------------------------------------------
 void StringInterface::setParameterList(const NameValuePairList& paramList) {
   NameValuePairList::const_iterator i, iend;
@@ -142,8 +290,29 @@ void StringInterface::setParameterList(const NameValuePairList& paramList) {
 std::string StringInterface::getParameter(const std::string& name) const {
   const ParamDictionary* dict = getParamDict();
   const ParamCmd* cmd = dict->getParamCmd(name);
-  if (cmd) return cmd->doGet(this);
-  return "";
+  if (!cmd) return "";
+
+  if (msNumPending.load() != 0) {
+    std::lock_guard<std::mutex> lock(msPendingMutex);
+    PendingIndex::const_iterator iter =
+        msPendingIndex.find(std::make_pair(this, name));
+    if (iter != msPendingIndex.end() &&
+        !msPendingParams[iter->second].isTyped())
+      return msPendingParams[iter->second].value;
+  }
+  return cmd->doGet(this);
+}
+
+//------------------------------------------------------------------------------
+size_t StringInterface::getParamGeneration(const std::string& name) const {
+  ParamGenerations::const_iterator iter = mParamGenerations.find(name);
+  return iter == mParamGenerations.end() ? 0 : iter->second;
+}
+
+//------------------------------------------------------------------------------
+void StringInterface::markChanged(const std::string& name) {
+  mParamGenerations[name] = ++msChangeGeneration;
+  if (mOwnerDir) mOwnerDir->markChanged(name, msChangeGeneration);
 }
 
 //------------------------------------------------------------------------------
@@ -160,23 +329,124 @@ void StringInterface::copyParametersTo(StringInterface* dest) const {
 
   if (dict) {
     // Iterate through own parameters
-    ParamMap::const_iterator i;
-
-    for (i = dict->mParamMap.begin(); i != dict->mParamMap.end(); ++i) {
-      dest->setParameter(i->first, getParameter(i->first));
-    }
+    std::for_each(dict->mNames.begin(), dict->mNames.end(),
+        [&](const std::string& v) -> void {
+          dest->setParameter(v, getParameter(v));
+        });
   }
 }
 
 //------------------------------------------------------------------------------
 void StringInterface::serialize(std::ostream& os, size_t lvl /*= 0*/) {
-  const StringVector&& params = getParameters();
-  std::string indent(" ", lvl);
-  std::for_each(params.begin(), params.end(),
-      [&](const std::string& v)
-          -> void { os << indent << v << this->getParameter(v); });
+  const StringVector& params = getParameters();
+  std::string indent(lvl * 2, ' ');
+  std::for_each(params.begin(), params.end(), [&](const std::string& v) -> void {
+    os << indent << v << " " << this->getParameter(v) << "\n";
+  });
 }
 
 //-----------------------------------------------------------------------------
 void StringInterface::cleanupDictionary() { msDictionary.clear(); }
+
+//------------------------------------------------------------------------------
+void StringInterface::setDeferred(bool v) {
+  if (msDeferred && !v) commitParameters();
+  msDeferred = v;
+}
+
+//------------------------------------------------------------------------------
+size_t StringInterface::commitParameters() {
+  if (msPendingParams.empty()) return 0;
+
+  // swap out first, doSet might set other params
+  PendingParams params;
+  {
+    std::lock_guard<std::mutex> lock(msPendingMutex);
+    params.swap(msPendingParams);
+    msPendingIndex.clear();
+    msNumPending = 0;
+  }
+
+  size_t numApplied = 0;
+  std::for_each(params.begin(), params.end(), [&](PendingParam& v) -> void {
+    if (!v.si) return;
+    try {
+      v.apply(v.si);
+      ++numApplied;
+    } catch (Exception& e) {
+      sgLogger.logMessage(
+          "failed to commit " + (v.isTyped() ? "typed value" : v.value) +
+              " : " + e.getDescription(),
+          SL_ERROR);
+    }
+  });
+  return numApplied;
+}
+
+//------------------------------------------------------------------------------
+void StringInterface::deferParameter(
+    const std::string& name, ParamCmd* cmd, const std::string& value) {
+  std::lock_guard<std::mutex> lock(msPendingMutex);
+  PendingParam& param = getPendingParam(name, cmd);
+  param.value = value;
+  param.typedValue = ParamValue();
+}
+
+//------------------------------------------------------------------------------
+void StringInterface::deferValue(
+    const std::string& name, ParamCmd* cmd, const ParamValue& value) {
+  std::lock_guard<std::mutex> lock(msPendingMutex);
+  PendingParam& param = getPendingParam(name, cmd);
+  param.value.clear();
+  param.typedValue = value;
+}
+
+//------------------------------------------------------------------------------
+StringInterface::PendingParam& StringInterface::getPendingParam(
+    const std::string& name, ParamCmd* cmd) {
+  std::pair<PendingIndex::iterator, bool> res = msPendingIndex.insert(
+      std::make_pair(std::make_pair(this, name), msPendingParams.size()));
+  if (res.second) {
+    PendingParam param = {this, cmd, std::string(), ParamValue()};
+    msPendingParams.push_back(param);
+    msNumPending = msPendingIndex.size();
+  }
+  return msPendingParams[res.first->second];
+}
+
+//------------------------------------------------------------------------------
+void StringInterface::PendingParam::apply(StringInterface* target) {
+  if (!isTyped()) {
+    cmd->doSet(target, value);
+  } else if (!cmd->doSetValue(target, typedValue)) {
+    PAC_EXCEPT(Exception::ERR_INVALIDPARAMS, "typed set is not supported");
+  }
+}
+
+//------------------------------------------------------------------------------
+void StringInterface::flushPendingParameters(bool discard /*= false*/) {
+  if (msPendingIndex.empty()) return;
+
+  // index is sorted by string interface, pending writes of this are adjacent
+  PendingIndex::iterator first =
+      msPendingIndex.lower_bound(std::make_pair(this, std::string()));
+  PendingIndex::iterator last = first;
+  SizetVector indices;
+  while (last != msPendingIndex.end() && last->first.first == this)
+    indices.push_back((last++)->second);
+  if (indices.empty()) return;
+  {
+    std::lock_guard<std::mutex> lock(msPendingMutex);
+    msPendingIndex.erase(first, last);
+    msNumPending = msPendingIndex.size();
+  }
+
+  // keep record order
+  std::sort(indices.begin(), indices.end());
+  std::for_each(indices.begin(), indices.end(), [&](size_t i) -> void {
+    PendingParam& param = msPendingParams[i];
+    param.si = 0;
+    if (!discard) param.apply(this);
+  });
+}
 }
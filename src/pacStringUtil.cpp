@@ -312,6 +312,41 @@ std::string StringUtil::join(
   return ss.str();
 }
 
+//------------------------------------------------------------------------------
+void StringUtil::appendJsonString(
+    std::string& dst, const char* data, size_t size) {
+  static const char* hex = "0123456789abcdef";
+  dst.push_back('"');
+  for (const char* p = data; p != data + size; ++p) {
+    switch (*p) {
+      case '"':
+        dst.append("\\\"");
+        break;
+      case '\\':
+        dst.append("\\\\");
+        break;
+      case '\n':
+        dst.append("\\n");
+        break;
+      case '\r':
+        dst.append("\\r");
+        break;
+      case '\t':
+        dst.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(*p) < 0x20) {
+          dst.append("\\u00");
+          dst.push_back(hex[(*p >> 4) & 0xF]);
+          dst.push_back(hex[*p & 0xF]);
+        } else {
+          dst.push_back(*p);
+        }
+    }
+  }
+  dst.push_back('"');
+}
+
 //-------------------------------------------------------------------------------------
 std::string StringUtil::toFixedLength(
     const std::string& s, size_t length, char c /*= ' '*/) {
@@ -351,44 +386,27 @@ bool StringUtil::match(
     StringUtil::toLowerCase(tmpPattern);
   }
 
-  std::string::const_iterator strIt = tmpStr.begin();
-  std::string::const_iterator patIt = tmpPattern.begin();
-  std::string::const_iterator lastWildCardIt = tmpPattern.end();
-  while (strIt != tmpStr.end() && patIt != tmpPattern.end()) {
-    if (*patIt == '*') {
-      lastWildCardIt = patIt;
-      // Skip over looking for next character
-      ++patIt;
-      if (patIt == tmpPattern.end()) {
-        // Skip right to the end since * matches the entire rest of the string
-        strIt = tmpStr.end();
-      } else {
-        // scan until we find next pattern character
-        while (strIt != tmpStr.end() && *strIt != *patIt) ++strIt;
-      }
+  // on mismatch, let the last '*' eat one more character and retry
+  size_t strPos = 0, patPos = 0;
+  size_t wildCardPos = std::string::npos, wildCardStrPos = 0;
+  while (strPos != tmpStr.size()) {
+    if (patPos != tmpPattern.size() && tmpPattern[patPos] == '*') {
+      wildCardPos = patPos++;
+      wildCardStrPos = strPos;
+    } else if (patPos != tmpPattern.size() &&
+               tmpPattern[patPos] == tmpStr[strPos]) {
+      ++patPos;
+      ++strPos;
+    } else if (wildCardPos != std::string::npos) {
+      patPos = wildCardPos + 1;
+      strPos = ++wildCardStrPos;
     } else {
-      if (*patIt != *strIt) {
-        if (lastWildCardIt != tmpPattern.end()) {
-          // The last wildcard can match this incorrect sequence
-          // rewind pattern to wildcard and keep searching
-          patIt = lastWildCardIt;
-          lastWildCardIt = tmpPattern.end();
-        } else {
-          // no wildwards left
-          return false;
-        }
-      } else {
-        ++patIt;
-        ++strIt;
-      }
+      return false;
     }
   }
-  // If we reached the end of both the pattern and the string, we succeeded
-  if (patIt == tmpPattern.end() && strIt == tmpStr.end()) {
-    return true;
-  } else {
-    return false;
-  }
+  // trailing wildcards match empty string
+  while (patPos != tmpPattern.size() && tmpPattern[patPos] == '*') ++patPos;
+  return patPos == tmpPattern.size();
 }
 //------------------------------------------------------------------------------
 const std::string StringUtil::replaceAll(const std::string& source,
@@ -596,6 +614,20 @@ Real StringUtil::parseReal(const std::string& val, Real defaultValue) {
 
   return ret;
 }
+//------------------------------------------------------------------------------
+bool StringUtil::parseReals(const std::string& val, RealVector& reals) {
+  const char* p = val.c_str();
+  while (true) {
+    while (isspace(*p)) ++p;
+    if (*p == 0) return true;
+    char* end;
+    Real r = strtof(p, &end);
+    if (end == p) return false;
+    reals.push_back(r);
+    p = end;
+  }
+}
+
 //------------------------------------------------------------------------------
 int StringUtil::parseInt(const std::string& val, int defaultValue) {
   // Use iStringStream for direct correspondence with toString
@@ -4,6 +4,7 @@
 #include "pacArgHandler.h"
 #include "pacIntrinsicArgHandler.h"
 #include "pacException.h"
+#include "pacSlabPool.h"
 #include "gtest/gtest.h"
 
 namespace pac {
@@ -20,13 +21,37 @@ TEST_F(TestConsoleSystem, addDuplicateChild) {
 }
 
 TEST_F(TestConsoleSystem, getParameters) {
-  StringVector&& sv = dir0->getParameters();
+  const StringVector& sv = dir0->getParameters();
   EXPECT_EQ(3, sv.size());
   EXPECT_STREQ("paramBool", sv[0].c_str());
   EXPECT_STREQ("paramInt", sv[1].c_str());
   EXPECT_STREQ("paramString", sv[2].c_str());
 }
 
+TEST(ParamDictionary, lookup) {
+  TestSI::ParamBool cmd;
+  ParamDictionary dict;
+  StringVector names;
+  for (int i = 99; i >= 0; --i) {
+    dict.addParameter("param" + StringUtil::toString(i), &cmd);
+    names.push_back("param" + StringUtil::toString(i));
+  }
+  dict.addParameter("param7", 0);
+  std::sort(names.begin(), names.end());
+
+  const StringVector& params = dict.getParameters();
+  EXPECT_EQ(names, params);
+  EXPECT_EQ(&params, &dict.getParameters());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_TRUE(dict.hasParameter("param" + StringUtil::toString(i)));
+  EXPECT_FALSE(dict.hasParameter("param100"));
+  EXPECT_FALSE(dict.hasParameter(""));
+  EXPECT_FALSE(ParamDictionary().hasParameter("param0"));
+  EXPECT_EQ(&cmd, dict.getParamDefs()[std::find(names.begin(), names.end(),
+                                          "param7") - names.begin()]
+                      .paramCmd);
+}
+
 TEST_F(TestConsoleSystem, getsetParameter) {
   dir0->setParameter("paramInt", "1");
   EXPECT_EQ("1", dir0->getParameter("paramInt"));
@@ -49,6 +74,72 @@ TEST_F(TestConsoleSystem, getsetParameter) {
       dir0->setParameter("paramString", "true"), InvalidParametersException);
 }
 
+TEST_F(TestConsoleSystem, setParameterReuseValidator) {
+  StringInterface* si = dir0->getStringInterface();
+  NameValuePairList params;
+  params["paramInt"] = "3";
+  params["paramBool"] = "false";
+  params["paramString"] = "two";
+  si->setParameterList(params);  // warm up validators
+
+  size_t numCreated = ArgHandler::getNumCreated();
+  for (int i = 0; i < 100; ++i) {
+    params["paramInt"] = StringUtil::toString(i);
+    si->setParameterList(params);
+  }
+  EXPECT_EQ(numCreated, ArgHandler::getNumCreated());
+  EXPECT_EQ("99", dir0->getParameter("paramInt"));
+
+  // validator is still usable after a failed set
+  EXPECT_THROW(dir0->setParameter("paramInt", "abc"),
+      InvalidParametersException);
+  dir0->setParameter("paramInt", "5");
+  EXPECT_EQ("5", dir0->getParameter("paramInt"));
+  EXPECT_EQ(numCreated, ArgHandler::getNumCreated());
+}
+
+TEST_F(TestConsoleSystem, getsetValue) {
+  StringInterface* si = dir0->getStringInterface();
+  size_t numCreated = ArgHandler::getNumCreated();
+  EXPECT_TRUE(si->setValue("paramInt", ParamValue::makeInt(42)));
+  EXPECT_TRUE(si->setValue("paramBool", ParamValue::makeBool(true)));
+  ParamValue value;
+  EXPECT_TRUE(si->getValue("paramInt", value));
+  EXPECT_EQ(ParamValue::makeInt(42), value);
+  EXPECT_TRUE(si->getValue("paramBool", value));
+  EXPECT_TRUE(value.getBool());
+  EXPECT_EQ(numCreated, ArgHandler::getNumCreated());
+
+  // string path sees typed writes and vice versa
+  EXPECT_EQ("42", dir0->getParameter("paramInt"));
+  dir0->setParameter("paramInt", "7");
+  si->getValue("paramInt", value);
+  EXPECT_EQ(7, value.getInt());
+
+  EXPECT_THROW(si->setValue("paramInt", ParamValue::makeReal(1)),
+      InvalidParametersException);
+  EXPECT_FALSE(si->setValue("paramString", ParamValue::makeInt(1)));
+  EXPECT_FALSE(si->getValue("paramString", value));
+  EXPECT_FALSE(si->setValue("paramNone", ParamValue::makeInt(1)));
+
+  Real reals[] = {1, 2, 3, 4, 5};
+  EXPECT_EQ(3, ParamValue::makeReals(reals, 3).getNumReals());
+  EXPECT_THROW(ParamValue::makeReals(reals, 3).getReals(4),
+      InvalidParametersException);
+  EXPECT_THROW(ParamValue::makeReals(reals, 5), InvalidParametersException);
+  EXPECT_THROW(ParamValue::makeReals(reals, 3).getReals(3, -1, 1),
+      InvalidParametersException);
+
+  // typed set checks the same range as string set
+  ConsoleUI* ui = sgConsole.getUi();
+  EXPECT_THROW(ui->setValue("alpha", ParamValue::makeReal(5)),
+      InvalidParametersException);
+  EXPECT_TRUE(ui->setValue("alpha", ParamValue::makeReal(0.5)));
+  EXPECT_EQ(0.5, ui->getAlpha());
+  EXPECT_THROW(ui->setValue("maxLines", ParamValue::makeInt(-1)),
+      InvalidParametersException);
+}
+
 TEST_F(TestConsoleSystem, getFullPath) {
   EXPECT_EQ(d, sgRootDir.getFullPath());
   EXPECT_EQ(pathDir0, dir0->getFullPath());
@@ -96,6 +187,217 @@ TEST_F(TestConsoleSystem, findAbsolutePath) {
   EXPECT_EQ(dir0_1_0, AbsDirUtil::findPath(pathDir0_1_0, &sgRootDir));
   EXPECT_EQ(dir0_1_1, AbsDirUtil::findPath(pathDir0_1_1, &sgRootDir));
 }
+
+TEST_F(TestConsoleSystem, childIndex) {
+  EXPECT_EQ(dir0_1, dir0->findChild("dir0_1"));
+  EXPECT_EQ(0, dir0->findChild("dir0_2"));
+  EXPECT_THROW(dir0->getChildByName("dir0_2"), ItemIdentityException);
+
+  // duplicated name, 1st added one is found
+  AbsDir* dup = new AbsDir("dir0_1");
+  dir0->addChild(dup);
+  EXPECT_EQ(dir0_1, dir0->findChild("dir0_1"));
+  dir0_1->setName("dir0_2");
+  EXPECT_EQ(dup, dir0->findChild("dir0_1"));
+  EXPECT_EQ(dir0_1, dir0->findChild("dir0_2"));
+  EXPECT_EQ(dir0_1, AbsDirUtil::findPath(pathDir0 + "dir0_2"));
+  delete dup;
+  EXPECT_FALSE(dir0->hasChild("dir0_1"));
+
+  AbsDirs dirs;
+  dir0->findChildrenByPrefix("dir0_", dirs);
+  ASSERT_EQ(2, dirs.size());
+  EXPECT_EQ(dir0_0, dirs[0]);
+  EXPECT_EQ(dir0_1, dirs[1]);
+  dirs.clear();
+  dir0->findChildrenByPrefix("dir0_2", dirs);
+  ASSERT_EQ(1, dirs.size());
+  EXPECT_EQ(dir0_1, dirs[0]);
+
+  dir0_1->setName("dir0_1");
+  EXPECT_EQ(0, AbsDirUtil::findPath(pathDir0 + "dir0_2"));
+}
+
+TEST_F(TestConsoleSystem, pathCache) {
+  std::string path = pathDir0_0 + "dir0_0_2";
+  EXPECT_EQ(0, AbsDirUtil::findPath(path));
+  EXPECT_EQ(dir0_0_0, AbsDirUtil::findPath("dir0_0_0", dir0_0));
+
+  size_t generation = AbsDir::getGeneration();
+  AbsDir* dir0_0_2 = new AbsDir("dir0_0_2");
+  dir0_0->addChild(dir0_0_2);
+  EXPECT_NE(generation, AbsDir::getGeneration());
+  EXPECT_EQ(dir0_0_2, AbsDirUtil::findPath(path));
+  EXPECT_EQ(dir0_0_2, AbsDirUtil::findPath("dir0_0_2", dir0_0));
+  EXPECT_EQ(dir0_0_2, AbsDirUtil::findPath(".." + d + "dir0_0_2", dir0_0_0));
+
+  dir0_0_2->setName("dir0_0_3");
+  EXPECT_EQ(0, AbsDirUtil::findPath(path));
+
+  delete dir0_0_2;
+  EXPECT_EQ(0, AbsDirUtil::findPath(pathDir0_0 + "dir0_0_3"));
+  EXPECT_EQ(dir0_0_0, AbsDirUtil::findPath("dir0_0_0", dir0_0));
+}
+
+TEST_F(TestConsoleSystem, cachedFullPath) {
+  dir0_0->setName("dir0_2");
+  EXPECT_EQ(pathDir0 + "dir0_2" + d, dir0_0->getFullPath());
+  EXPECT_EQ(pathDir0 + "dir0_2" + d + "dir0_0_0" + d, dir0_0_0->getFullPath());
+  dir0_0->setName("dir0_0");
+  EXPECT_EQ(pathDir0_0_0, dir0_0_0->getFullPath());
+
+  // reparent
+  dir0_0->removeChild(dir0_0_0);
+  dir0_1->addChild(dir0_0_0);
+  EXPECT_EQ(pathDir0_1 + "dir0_0_0" + d, dir0_0_0->getFullPath());
+}
+
+TEST_F(TestConsoleSystem, cleanManyTempDirs) {
+  AbsDir* base = createBase();
+  AbsDir* keep = new AbsDir("keep");
+  base->addChild(keep, false);
+  addItems(base, 2000, "temp", true, true);
+  for (size_t i = 0; i < base->getNumChildren(); ++i)
+    if (base->getChildAt(i) != keep)
+      base->getChildAt(i)->addChild(new AbsDir("child"));
+  AbsDir* tempUnderKeep = new AbsDir("temp");
+  keep->addChild(tempUnderKeep);
+  sgConsole.setCwd(tempUnderKeep);
+
+  sgConsole.cleanTempDirs();
+  dir0 = 0;
+  EXPECT_EQ(1, base->getNumChildren());
+  EXPECT_EQ(keep, base->findChild("keep"));
+  EXPECT_EQ(0, base->findChild("temp0"));
+  EXPECT_EQ(0, keep->getNumChildren());
+  EXPECT_EQ(&sgRootDir, sgConsole.getCwd());
+}
+
+TEST_F(TestConsoleSystem, dirMemory) {
+  const size_t numDirs = 2000;
+  AbsDir* base = createBase();
+
+  addItems(base, numDirs, "temp", true, true);
+  size_t bytes = base->getMemoryUsage(true) - sizeof(AbsDir);
+  RecordProperty("bytesPerDir", static_cast<int>(bytes / numDirs));
+  EXPECT_LE(numDirs, AbsDir::getPool().getNumAllocated());
+  base->cleanTempDirs();
+  EXPECT_EQ(0, base->getNumChildren());
+
+  // freed dirs are reused
+  size_t numSlabs = AbsDir::getPool().getNumSlabs();
+  addItems(base, numDirs, "temp", true, true);
+  EXPECT_EQ(numSlabs, AbsDir::getPool().getNumSlabs());
+  base->cleanTempDirs();
+}
+
+TEST(SlabPool, reuse) {
+  SlabPool pool(24, 4);
+  EXPECT_EQ(24, pool.getBlockSize());
+  void* blocks[5];
+  for (int i = 0; i < 5; ++i) blocks[i] = pool.allocate();
+  EXPECT_EQ(2, pool.getNumSlabs());
+  EXPECT_EQ(5, pool.getNumAllocated());
+  EXPECT_EQ(static_cast<char*>(blocks[0]) + 24, blocks[1]);
+
+  pool.deallocate(blocks[2]);
+  EXPECT_EQ(blocks[2], pool.allocate());
+  for (int i = 0; i < 5; ++i) pool.deallocate(blocks[i]);
+  EXPECT_EQ(0, pool.getNumAllocated());
+  EXPECT_EQ(2 * 4 * 24, pool.getCapacity());
+}
+
+TEST(SlabAllocator, nodes) {
+  typedef std::pair<const int, int> Value;
+  SlabPool& pool = SlabAllocator<Value>::getPool();
+  size_t numAllocated = pool.getNumAllocated();
+
+  SlabAllocator<Value> alloc;
+  Value* p = alloc.allocate(1);
+  EXPECT_EQ(numAllocated + 1, pool.getNumAllocated());
+  alloc.deallocate(p, 1);
+  EXPECT_EQ(numAllocated, pool.getNumAllocated());
+
+  // arrays don't touch pool
+  p = alloc.allocate(8);
+  EXPECT_EQ(numAllocated, pool.getNumAllocated());
+  alloc.deallocate(p, 8);
+
+  std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+      SlabAllocator<Value>> m;
+  for (int i = 0; i < 100; ++i) m[i] = i;
+  EXPECT_EQ(100, m.size());
+  EXPECT_EQ(99, m[99]);
+  m.clear();
+}
+
+class TestChildProvider : public ChildProvider {
+public:
+  TestChildProvider(size_t numChildren)
+      : mNumChildren(numChildren), mNumCreated(0) {}
+
+  virtual void getChildNames(StringVector& names) {
+    for (size_t i = 0; i < mNumChildren; ++i)
+      names.push_back("item" + StringUtil::toString(i));
+  }
+
+  virtual StringInterface* createStringInterface(const std::string& name) {
+    if (name.compare(0, 4, "item") != 0) return 0;
+    size_t i = StringUtil::parseInt(name.substr(4));
+    if (i >= mNumChildren) return 0;
+    ++mNumCreated;
+    return new TestSI();
+  }
+
+  size_t mNumChildren;
+  size_t mNumCreated;
+};
+
+TEST_F(TestConsoleSystem, virtualDir) {
+  TestChildProvider* provider = new TestChildProvider(1000);
+  VirtualDir* vdir = new VirtualDir("virtual", provider);
+  sgRootDir.addChild(vdir, false);
+
+  // listing and completion don't materialize anything
+  StringVector names;
+  vdir->getChildNames("item99", names);
+  EXPECT_EQ(StringVector({"item99", "item990", "item991", "item992",
+                "item993", "item994", "item995", "item996", "item997",
+                "item998", "item999"}),
+      names);
+  sgConsole.execute("ls " + d + "virtual");
+  EXPECT_TRUE(vdir->hasChild("item5"));
+  EXPECT_FALSE(vdir->hasChild("item1000"));
+  EXPECT_EQ(0, vdir->getNumChildren());
+  EXPECT_EQ(0, provider->mNumCreated);
+
+  // cd and set materialize a single child
+  sgConsole.execute("cd " + d + "virtual" + d + "item5");
+  AbsDir* item5 = sgConsole.getCwd();
+  EXPECT_EQ(d + "virtual" + d + "item5" + d, item5->getFullPath());
+  sgConsole.execute("set " + d + "virtual" + d + "item7 paramInt 7");
+  EXPECT_EQ(2, vdir->getNumChildren());
+  EXPECT_EQ(2, provider->mNumCreated);
+  EXPECT_EQ("7", vdir->findChild("item7")->getParameter("paramInt"));
+  EXPECT_EQ(item5, vdir->findChild("item5"));
+  EXPECT_EQ(0, vdir->findChild("nothing"));
+  EXPECT_EQ(2, provider->mNumCreated);
+
+  // missed lookup is not cached, provider can add children any time
+  std::string path = d + "virtual" + d + "item1000";
+  EXPECT_EQ(0, AbsDirUtil::findPath(path));
+  provider->mNumChildren = 1001;
+  AbsDir* item1000 = AbsDirUtil::findPath(path);
+  EXPECT_TRUE(item1000 != 0);
+  EXPECT_EQ(item1000, vdir->findChild("item1000"));
+
+  // materialized children are temp
+  sgConsole.cleanTempDirs();
+  dir0 = 0;
+  EXPECT_EQ(0, vdir->getNumChildren());
+  EXPECT_EQ(&sgRootDir, sgConsole.getCwd());
+  delete vdir;
+}
 }
 
 #endif /* TESTABSDIR_H */
@@ -87,4 +87,57 @@ TEST_F(TestCmdHistory2, previous) {
 
 }
 
+TEST(CmdHistory, search) {
+  CmdHistory history(10);
+  history.push("ls dir0");
+  history.push("set paramInt 1");
+  history.push("get paramInt");
+  history.push("ls dir0");
+  history.push("cd dir0");
+  EXPECT_EQ(5u, history.getNumEntries());
+  EXPECT_EQ(4u, history.getNumUniqueEntries());
+
+  // most recent first, duplicates only once
+  EXPECT_EQ(StringVector({"get paramInt", "set paramInt 1"}),
+      history.search("paramInt"));
+  EXPECT_EQ(StringVector({"cd dir0", "ls dir0"}), history.search("r0"));
+  EXPECT_EQ(StringVector({"ls dir0"}), history.search("ls", true));
+  EXPECT_EQ(StringVector({"get paramInt"}), history.search("get p", true));
+  EXPECT_TRUE(history.search("t p", true).empty());
+  EXPECT_TRUE(history.search("xyz").empty());
+
+  EXPECT_EQ("cd dir0", history.reverseSearch("dir"));
+  EXPECT_EQ("ls dir0", history.reverseSearch("dir", 1));
+  EXPECT_EQ("", history.reverseSearch("dir", 2));
+}
+
+TEST(CmdHistory, load) {
+  const std::string path = "testCmdHistory.tmp";
+  std::remove(path.c_str());
+  {
+    CmdHistory history(3);
+    history.load(path);
+    for (int i = 0; i < 5; ++i) history.push("cmd " + StringUtil::toString(i));
+    history.push("cmd 1");
+  }
+
+  CmdHistory history(3);
+  history.push("pushed before load");
+  history.load(path);
+  // rolling stack only holds the last 3 lines
+  EXPECT_EQ("pushed before load", history.previous());
+  EXPECT_EQ("cmd 1", history.previous());
+  EXPECT_EQ("cmd 4", history.previous());
+  EXPECT_EQ("cmd 4", history.previous());
+
+  EXPECT_EQ(7u, history.getNumEntries());
+  EXPECT_EQ(6u, history.getNumUniqueEntries());
+  EXPECT_EQ(StringVector({"cmd 1", "cmd 4", "cmd 3", "cmd 2", "cmd 0"}),
+      history.search("cmd"));
+
+  history.push("cmd 5");
+  EXPECT_EQ("cmd 5", history.reverseSearch("cmd"));
+  std::remove(path.c_str());
+}
+
 #endif /* TESTCMDHISTORY_H */
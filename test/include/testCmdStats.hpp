@@ -0,0 +1,60 @@
+#ifndef TESTCMDSTATS_H
+#define TESTCMDSTATS_H
+
+#include "pacCmdStats.h"
+#include "testConsoleSystem.hpp"
+#include <gtest/gtest.h>
+
+namespace pac {
+
+TEST(LatencyHistogram, percentile) {
+  LatencyHistogram h;
+  EXPECT_EQ(0u, h.getPercentile(0.5));
+  for (unsigned long long i = 1; i <= 100; ++i) h.add(i * 1000);
+  EXPECT_EQ(100u, h.getCount());
+  EXPECT_EQ(100000u, h.getMax());
+  // bucket upper bound is at most 19% above the exact value
+  EXPECT_LE(50000u, h.getPercentile(0.5));
+  EXPECT_GE(50000u * 1.19, h.getPercentile(0.5));
+  EXPECT_LE(99000u, h.getPercentile(0.99));
+  EXPECT_GE(100000u, h.getPercentile(0.99));
+  h.reset();
+  EXPECT_EQ(0u, h.getCount());
+  EXPECT_EQ(0u, h.getMax());
+}
+
+TEST_F(TestConsoleSystem, cmdStats) {
+  CmdStats* stats = sgConsole.getCmdStats();
+  CmdStats::setEnabled(false);
+  stats->reset();
+  sgConsole.execute("pwd");
+  EXPECT_EQ(0u, stats->getRecord("pwd")->getHistogram(CP_EXECUTE).getCount());
+
+  EXPECT_TRUE(sgConsole.execute("set " + d + "stats enabled true"));
+  sgConsole.execute("pwd");
+  sgConsole.execute("ls");
+  sgConsole.execute("ls dir0");
+  CmdStatsRecord* record = stats->getRecord("ls");
+  EXPECT_EQ(2u, record->getHistogram(CP_LEX).getCount());
+  EXPECT_EQ(2u, record->getHistogram(CP_CLONE).getCount());
+  EXPECT_EQ(2u, record->getHistogram(CP_VALIDATE).getCount());
+  EXPECT_EQ(2u, record->getHistogram(CP_EXECUTE).getCount());
+  EXPECT_EQ(2u, record->getHistogram(CP_FORMAT).getCount());
+  EXPECT_EQ("0:1 1:1", record->getBranches());
+  EXPECT_EQ(2u, record->getNumHandlers().getCount());
+
+  // browsable as dir
+  AbsDir* dir = AbsDirUtil::findPath(d + "stats" + d + "ls");
+  ASSERT_TRUE(dir);
+  EXPECT_EQ("2", StringUtil::split(dir->getParameter("execute"))[0]);
+  EXPECT_TRUE(sgConsole.execute("get " + d + "stats" + d + "pwd"));
+
+  EXPECT_TRUE(sgConsole.execute("set " + d + "stats reset true"));
+  EXPECT_EQ(0u, record->getHistogram(CP_EXECUTE).getCount());
+  EXPECT_EQ("", record->getBranches());
+  EXPECT_TRUE(sgConsole.execute("set " + d + "stats enabled false"));
+  EXPECT_FALSE(CmdStats::getEnabled());
+}
+}
+
+#endif /* TESTCMDSTATS_H */
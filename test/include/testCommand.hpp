@@ -4,10 +4,18 @@
 #include "pacConsole.h"
 #include "pacCommand.h"
 #include "pacException.h"
+#include "pacIntrinsicCmd.h"
 #include <gtest/gtest.h>
+#include <chrono>
 
 namespace pac {
 
+class LazyGrammarCmd : public SetCmd {
+public:
+  LazyGrammarCmd() { setName("lazyGrammar"); }
+  virtual Command* clone() { return new LazyGrammarCmd(*this); }
+};
+
 class TestCommand : public ::testing::Test {
 protected:
   virtual void SetUp() { mCmd = sgCmdLib.createCommand("ls"); }
@@ -57,6 +65,37 @@ TEST_F(TestCommand, setArgsAndOptions) {
   EXPECT_THROW(
       mCmd->setArgsAndOptions(" abc d- abc"), InvalidParametersException);
 }
+
+TEST(CommandLib, lazyGrammar) {
+  Command* proto = new LazyGrammarCmd();
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point t0 = Clock::now();
+  sgCmdLib.registerCommand(proto);
+  Clock::time_point t1 = Clock::now();
+  EXPECT_FALSE(proto->isInitialized());
+
+  // the 1st create builds grammar of prototype
+  Command* cmd = sgCmdLib.createCommand("lazyGrammar");
+  Clock::time_point t2 = Clock::now();
+  EXPECT_TRUE(proto->isInitialized());
+  delete cmd;
+  cmd = sgCmdLib.createCommand("lazyGrammar");
+  Clock::time_point t3 = Clock::now();
+  delete cmd;
+
+  sgCmdLib.unregisterCommand("lazyGrammar");
+  EXPECT_EQ(0, sgCmdLib.createCommand("lazyGrammar"));
+  EXPECT_THROW(
+      sgCmdLib.unregisterCommand("lazyGrammar"), ItemIdentityException);
+
+  typedef std::chrono::microseconds Us;
+  RecordProperty(
+      "registerUs", std::chrono::duration_cast<Us>(t1 - t0).count());
+  RecordProperty(
+      "firstCreateUs", std::chrono::duration_cast<Us>(t2 - t1).count());
+  RecordProperty(
+      "secondCreateUs", std::chrono::duration_cast<Us>(t3 - t2).count());
+}
 }
 
 #endif /* TESTCOMMAND_HPP */
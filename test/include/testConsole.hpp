@@ -5,6 +5,8 @@
 #include "pacConsoleUI.h"
 #include "pacIntrinsicArgHandler.h"
 #include "testConsoleUI.hpp"
+#include "pacOutputSink.h"
+#include <fstream>
 
 namespace pac {
 
@@ -163,7 +165,7 @@ TEST_F(TestConsoleSystem, promptCmdPwd) {
 
 TEST_F(TestConsoleSystem, executeCmdLs) {
   sgConsole.execute("ls");
-  ASSERT_EQ(getSortedVector({"consoleUi", "dir0"}), mUi->getItems());
+  ASSERT_EQ(getSortedVector({"consoleUi", "dir0", "stats"}), mUi->getItems());
   sgConsole.execute("ls dir0");
   ASSERT_EQ(getSortedVector({"dir0_0", "dir0_1"}), mUi->getItems());
 }
@@ -203,6 +205,85 @@ TEST_F(TestConsoleSystem, executeCmdSet) {
   EXPECT_FALSE(sgConsole.execute("set " + pathDir0 + " paramString x"));
 }
 
+TEST_F(TestConsoleSystem, executeCmdBulkSet) {
+  sgConsole.setCwd(dir0);
+  EXPECT_TRUE(sgConsole.execute("set glob dir0_*" + d + "* paramInt 5"));
+  EXPECT_STREQ("5", dir0_0_0->getParameter("paramInt").c_str());
+  EXPECT_STREQ("5", dir0_0_1->getParameter("paramInt").c_str());
+  EXPECT_STREQ("5", dir0_1_0->getParameter("paramInt").c_str());
+  EXPECT_STREQ("5", dir0_1_1->getParameter("paramInt").c_str());
+  EXPECT_EQ("set paramInt of 4 dirs : 4 succeeded, 0 failed\n",
+      getLastOutput());
+
+  EXPECT_TRUE(
+      sgConsole.execute("set glob " + pathDir0 + "*_1 paramString two"));
+  EXPECT_STREQ("two", dir0_1->getParameter("paramString").c_str());
+
+  EXPECT_TRUE(sgConsole.execute("set regex dir0_[01] paramInt 7"));
+  EXPECT_STREQ("7", dir0_0->getParameter("paramInt").c_str());
+  EXPECT_STREQ("7", dir0_1->getParameter("paramInt").c_str());
+
+  // invalid value is reported for every matched dir
+  EXPECT_FALSE(sgConsole.execute("set regex dir0_.* paramString x"));
+  EXPECT_STREQ("two", dir0_1->getParameter("paramString").c_str());
+  EXPECT_EQ("set paramString of 2 dirs : 0 succeeded, 2 failed\n",
+      getLastOutput());
+
+  // dir without string interface or param
+  EXPECT_FALSE(sgConsole.execute("set glob " + d + "* paramInt 1"));
+
+  // param must belong to at least one matched dir
+  EXPECT_FALSE(sgConsole.execute("set glob dir0_* paramNone 1"));
+  EXPECT_FALSE(sgConsole.execute("set regex dir0_.* paramNone 1"));
+  EXPECT_FALSE(sgConsole.execute("set regex nomatch paramInt 1"));
+}
+
+TEST_F(TestConsoleSystem, deferredSet) {
+  sgConsole.setCwd(dir0);
+  TestSI* si = static_cast<TestSI*>(dir0->getStringInterface());
+  si->setInt(0);
+  StringInterface::setDeferred(true);
+  EXPECT_TRUE(sgConsole.execute("set paramInt 1"));
+  EXPECT_TRUE(sgConsole.execute("set paramInt 2"));
+  EXPECT_TRUE(sgConsole.execute("set " + pathDir0_0 + " paramInt 3"));
+  EXPECT_FALSE(sgConsole.execute("set paramInt x"));
+  // coalesced, not applied yet
+  EXPECT_EQ(0, si->getInt());
+  EXPECT_EQ(2u, StringInterface::getNumPendingParameters());
+  EXPECT_STREQ("2", dir0->getParameter("paramInt").c_str());
+
+  // non deferrable param flushes pending writes of the same string interface
+  EXPECT_TRUE(sgConsole.execute("set paramBool true"));
+  EXPECT_EQ(2, si->getInt());
+  EXPECT_EQ(1u, StringInterface::getNumPendingParameters());
+
+  EXPECT_EQ(1u, StringInterface::commitParameters());
+  EXPECT_STREQ("3", dir0_0->getParameter("paramInt").c_str());
+  EXPECT_EQ(0u, StringInterface::getNumPendingParameters());
+
+  // pending writes of deleted string interface are dropped
+  EXPECT_TRUE(sgConsole.execute("set " + pathDir0_1_1 + " paramInt 4"));
+  delete dir0_1_1;
+  EXPECT_EQ(0u, StringInterface::getNumPendingParameters());
+  EXPECT_EQ(0u, StringInterface::commitParameters());
+
+  // typed writes are deferred and coalesced with string ones
+  ParamValue value;
+  EXPECT_TRUE(sgConsole.execute("set paramInt 5"));
+  EXPECT_TRUE(si->setValue("paramInt", ParamValue::makeInt(6)));
+  EXPECT_EQ(2, si->getInt());
+  EXPECT_EQ(1u, StringInterface::getNumPendingParameters());
+  EXPECT_TRUE(si->getValue("paramInt", value));
+  EXPECT_EQ(6, value.getInt());
+  EXPECT_EQ(1u, StringInterface::commitParameters());
+  EXPECT_EQ(6, si->getInt());
+  // wrong type is only caught at commit
+  EXPECT_TRUE(si->setValue("paramInt", ParamValue::makeReal(7)));
+  EXPECT_EQ(0u, StringInterface::commitParameters());
+  EXPECT_EQ(6, si->getInt());
+  StringInterface::setDeferred(false);
+}
+
 TEST_F(TestConsoleSystem, promptCmdSet) {
   sgConsole.setCwd(dir0);
   sgConsole.getUi()->setCmdLine("set paramString");
@@ -232,9 +313,254 @@ TEST_F(TestConsoleSystem, promptCmdSet) {
 
 TEST_F(TestConsoleSystem, executeCmdCtd) {
   sgConsole.execute("ctd");
-  EXPECT_EQ(1, sgRootDir.getNumChildren());
+  EXPECT_EQ(2, sgRootDir.getNumChildren());
   dir0 = 0;
 }
+
+TEST_F(TestConsoleSystem, streamOutput) {
+  EXPECT_EQ(Console::SM_BUFFER, sgConsole.getStreamMode());
+  EXPECT_TRUE(sgConsole.execute("set " + d + " streamMode page"));
+  EXPECT_TRUE(sgConsole.execute("set " + d + " pageSize 3"));
+  EXPECT_EQ(Console::SM_PAGE, sgConsole.getStreamMode());
+  EXPECT_EQ(3, sgConsole.getPageSize());
+  EXPECT_THROW(sgConsole.execute("set " + d + " pageSize 0"),
+      InvalidParametersException);
+  mUi->mNumOutputs = 0;
+  {
+    RaiiConsoleBuffer raii;
+    for (char c = 'g'; c >= 'a'; --c) sgConsole.output(std::string(1, c));
+    // 2 pages flushed, 1 item kept
+    EXPECT_EQ(2, mUi->mNumOutputs);
+    EXPECT_EQ("b  c  d  \n", getLastOutput());
+  }
+  EXPECT_EQ(3, mUi->mNumOutputs);
+  EXPECT_EQ("a  \n", getLastOutput());
+
+  sgConsole.setStreamMode(Console::SM_SINGLE_COLUMN);
+  {
+    RaiiConsoleBuffer raii;
+    sgConsole.output("abc");
+    EXPECT_EQ("abc  \n", getLastOutput());
+    sgConsole.output("d");
+    EXPECT_EQ("d  \n", getLastOutput());
+  }
+
+  sgConsole.setStreamMode(Console::SM_PAGE);
+  {
+    RaiiConsoleBuffer raii;
+    sgConsole.output("x");
+    sgConsole.cancelOutput();
+    EXPECT_TRUE(sgConsole.isOutputCancelled());
+    EXPECT_EQ("x  \n", getLastOutput());
+    sgConsole.output("y");
+    sgConsole.output("z");
+  }
+  EXPECT_FALSE(sgConsole.isOutputCancelled());
+  EXPECT_EQ("output cancelled, 2 items dropped\n", getLastOutput());
+
+  // limit cancels output
+  sgConsole.setOutputLimit(2);
+  {
+    RaiiConsoleBuffer raii;
+    for (char c = 'a'; c != 'f'; ++c) sgConsole.output(std::string(1, c));
+    EXPECT_TRUE(sgConsole.isOutputCancelled());
+  }
+  EXPECT_EQ("output cancelled, 3 items dropped\n", getLastOutput());
+  sgConsole.setOutputLimit(0);
+
+  EXPECT_TRUE(sgConsole.execute("set " + d + " streamMode buffer"));
+  sgConsole.setPageSize(4096);
+}
+
+TEST_F(TestConsoleSystem, scrollback) {
+  ImplConsoleUI ui;
+  ui.setMaxLines(3);
+  ui.output("ab");
+  ui.output("c\nde\n");
+  EXPECT_EQ(2, ui.getNumLines());
+  EXPECT_EQ("abc\n", ui.getLine(0));
+  ui.outputLine("f");
+  ui.output("g\nh");
+  EXPECT_EQ(3, ui.getNumLines());
+  EXPECT_EQ(7, ui.mNumEvicted);
+  EXPECT_EQ("f\ng\nh", ui.getScrollback());
+
+  ui.setParameter("maxLines", "1");
+  EXPECT_EQ("1", ui.getParameter("maxLines"));
+  EXPECT_EQ("h", ui.getScrollback());
+  EXPECT_EQ(11, ui.mNumEvicted);
+  ui.setMaxLines(2);
+  ui.output("ij\n");
+  EXPECT_EQ("hij\n", ui.getScrollback());
+}
+
+TEST_F(TestConsoleSystem, outputSinks) {
+  CaptureSink capture;
+  AsyncLogSink log;
+  {
+    FileSink tee("test_output_sink.txt", false);
+    sgConsole.addSink(&capture);
+    sgConsole.addSink(&tee);
+    sgConsole.addSink(&log);
+    EXPECT_THROW(sgConsole.addSink(&capture), ItemIdentityException);
+
+    std::string value("abc");
+    sgConsole.outputLine({"value", " : ", value});
+    EXPECT_EQ("value : abc\n", getLastOutput());
+    sgConsole.execute("get " + pathDir0 + " paramInt");
+    sgConsole.removeSink(&tee);
+  }
+  sgConsole.removeSink(&log);
+  sgConsole.removeSink(&capture);
+  EXPECT_THROW(sgConsole.removeSink(&capture), ItemIdentityException);
+  log.flush();
+
+  const std::string& captured = capture.getCaptured();
+  EXPECT_EQ(0, captured.find("value : abc\n"));
+  EXPECT_NE(std::string::npos, captured.find("paramInt : "));
+
+  {
+    std::ifstream ifs("test_output_sink.txt");
+    std::string content((std::istreambuf_iterator<char>(ifs)),
+        std::istreambuf_iterator<char>());
+    EXPECT_EQ(captured, content);
+  }
+  std::remove("test_output_sink.txt");
+
+  // empty write queues nothing, flush must not wait for it
+  Fragment empty("");
+  log.write(&empty, &empty + 1, 1);
+  log.flush();
+}
+
+TEST_F(TestConsoleSystem, batchOutput) {
+  mUi->mNumOutputs = 0;
+  sgConsole.execute("ls " + pathDir0);
+  // cwd echo and listing are handed to ui together
+  EXPECT_EQ(1, mUi->mNumOutputs);
+  EXPECT_EQ(getSortedVector({"dir0_0", "dir0_1"}), mUi->getItems());
+
+  mUi->mNumOutputs = 0;
+  sgConsole.getUi()->setCmdLine("cd " + pathDir0 + "dir0_");
+  sgConsole.prompt();
+  EXPECT_EQ(1, mUi->mNumOutputs);
+
+  mUi->mNumOutputs = 0;
+  {
+    RaiiConsoleBatch batch;
+    sgConsole.outputLine("a");
+    sgConsole.outputLine("b");
+    sgConsole.flushOutput();
+    EXPECT_EQ(1, mUi->mNumOutputs);
+    sgConsole.outputLine("c");
+    EXPECT_EQ(1, mUi->mNumOutputs);
+  }
+  EXPECT_EQ(2, mUi->mNumOutputs);
+  EXPECT_FALSE(mUi->getBatching());
+
+  // batch is bounded
+  mUi->mNumOutputs = 0;
+  mUi->setMaxBatchSize(4);
+  {
+    RaiiConsoleBatch batch;
+    sgConsole.outputLine("a");
+    sgConsole.outputLine("b");
+    EXPECT_EQ(1, mUi->mNumOutputs);
+    sgConsole.outputLine("c");
+    EXPECT_EQ(1, mUi->mNumOutputs);
+  }
+  EXPECT_EQ(2, mUi->mNumOutputs);
+  mUi->setMaxBatchSize(65536);
+
+  // every page reaches ui before listing ends
+  sgConsole.setStreamMode(Console::SM_PAGE);
+  sgConsole.setPageSize(1);
+  mUi->mNumOutputs = 0;
+  {
+    RaiiConsoleBatch batch;
+    RaiiConsoleBuffer buffer;
+    sgConsole.output("a");
+    EXPECT_EQ(1, mUi->mNumOutputs);
+    sgConsole.output("b");
+    EXPECT_EQ(2, mUi->mNumOutputs);
+  }
+  sgConsole.setStreamMode(Console::SM_BUFFER);
+  sgConsole.setPageSize(4096);
+}
+
+TEST_F(TestConsoleSystem, jsonOutput) {
+  CaptureSink capture;
+  sgConsole.addSink(&capture);
+  sgConsole.execute("ls -j " + pathDir0);
+  EXPECT_EQ(std::string::npos, capture.getCaptured().find("dir0_0  "));
+  EXPECT_NE(std::string::npos,
+      capture.getCaptured().find("{\"name\":\"dir0_0\"}\n{\"name\":\"dir0_1\"}\n"));
+  EXPECT_FALSE(sgConsole.getJsonOutput());
+
+  sgConsole.setJsonOutput(true);
+  dir0->setParameter("paramString", "two");
+  sgConsole.execute("get " + pathDir0 + " paramString");
+  EXPECT_EQ("{\"name\":\"paramString\",\"value\":\"two\"}\n",
+      getLastOutput());
+  sgConsole.setJsonOutput(false);
+  size_t size = capture.getCaptured().size();
+  sgConsole.outputRecord({});
+  EXPECT_EQ(size, capture.getCaptured().size());
+  sgConsole.removeSink(&capture);
+
+  sgConsole.execute("get " + pathDir0 + " paramString");
+  EXPECT_EQ("paramString : two  \n", getLastOutput());
+}
+
+TEST_F(TestConsoleSystem, executeCmdFind) {
+  AbsDir* base = createBase();
+  addItems(base, 2000);
+  VirtualDir* vdir = new VirtualDir("virtual", new TestChildProvider(100));
+  base->addChild(vdir, false);
+  std::string pathBase = d + "base" + d;
+  CaptureSink capture;
+
+  // skip echoed command line
+  auto captured = [&]() -> std::string {
+    const std::string& s = capture.getCaptured();
+    return s.substr(s.find('\n') + 1);
+  };
+  auto record = [&](const std::string& path, const std::string& value)
+      -> std::string {
+    std::string s("{\"path\":");
+    StringUtil::appendJsonString(s, path.data(), path.size());
+    if (!value.empty()) s += ",\"value\":\"" + value + "\"";
+    return s + "}\n";
+  };
+
+  sgConsole.addSink(&capture);
+  sgConsole.execute("find -j " + pathBase + " name item199*");
+  std::string expected = record(pathBase + "item199" + d, "");
+  for (int i = 0; i < 10; ++i)
+    expected += record(pathBase + "item199" + StringUtil::toString(i) + d, "");
+  EXPECT_EQ(expected, captured());
+
+  capture.clear();
+  sgConsole.execute("find -j " + pathBase + " param paramInt > 1996");
+  EXPECT_EQ(record(pathBase + "item1997" + d, "1997") +
+                record(pathBase + "item1998" + d, "1998") +
+                record(pathBase + "item1999" + d, "1999"),
+      captured());
+
+  // unmaterialized children of virtual dir are searched too
+  capture.clear();
+  sgConsole.execute("find -j " + pathBase + "virtual name item9*");
+  expected = "";
+  for (int i = 9; i < 100; i += (i == 9 ? 81 : 1))
+    expected += record(
+        pathBase + "virtual" + d + "item" + StringUtil::toString(i) + d, "");
+  EXPECT_EQ(expected, captured());
+  EXPECT_EQ(0, vdir->getNumChildren());
+  sgConsole.removeSink(&capture);
+
+  sgConsole.execute("find -j " + pathBase + "item2 param paramInt <= 2");
+  EXPECT_EQ(record(pathBase + "item2" + d, "2"), getLastOutput());
+}
 }
 
 #endif /* TESTCONSOLE_H */
@@ -5,6 +5,7 @@
 #include "pacConsolePattern.h"
 #include "pacStringUtil.h"
 #include <gtest/gtest.h>
+#include <chrono>
 
 using namespace pac;
 
@@ -272,4 +273,30 @@ TEST_F(TestConsolePattern80, 1000timesRandom) {
   }
 }
 
+/**
+ * 100k random items, time is recorded only
+ */
+TEST_F(TestConsolePattern80, 100kItems) {
+  size_t maxItemLen = 12, numItem = 100000;
+  srand((unsigned)time(NULL));
+  StringVector buffer;
+  buffer.reserve(numItem);
+  for (size_t i = 0; i < numItem; ++i) {
+    buffer.push_back(std::string(std::rand() % maxItemLen + 1, 'a' + i % 26));
+  }
+  resetBuffer(buffer.begin(), buffer.end());
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  const std::string&& s =
+      mPattern->applyPattern(mBuffer.begin(), mBuffer.end());
+  std::chrono::milliseconds ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          Clock::now() - start);
+  RecordProperty("milliseconds", static_cast<int>(ms.count()));
+
+  EXPECT_EQ(s.capacity(), s.size());
+  testOutputString(s, mPattern->mTextWidth);
+}
+
 #endif  // TESTPACCONSOLEPATTERN_H
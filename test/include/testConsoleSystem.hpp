@@ -14,7 +14,7 @@ namespace pac {
 
 class TestSI : public StringInterface {
 public:
-  TestSI() : StringInterface("test", true) {
+  TestSI() : StringInterface("test", true), mBool(false), mInt(0) {
     if (createParamDict()) {
       ParamDictionary* dict = getParamDict();
       dict->addParameter("paramBool", &msParamBool);
@@ -46,6 +46,14 @@ public:
       TestSI* si = static_cast<TestSI*>(target);
       si->setBool(StringUtil::parseBool(handler->getValue()));
     }
+    virtual bool doGetValue(const void* target, ParamValue& value) const {
+      value = ParamValue::makeBool(static_cast<const TestSI*>(target)->getBool());
+      return true;
+    }
+    virtual bool doSetValue(void* target, const ParamValue& value) {
+      static_cast<TestSI*>(target)->setBool(value.getBool());
+      return true;
+    }
   };
 
   struct ParamString : public ParamCmd {
@@ -61,7 +69,7 @@ public:
   };
 
   struct ParamInt : public ParamCmd {
-    ParamInt() : ParamCmd("int") {}
+    ParamInt() : ParamCmd("int", true) {}
     virtual std::string doGet(const void* target) const {
       const TestSI* si = static_cast<const TestSI*>(target);
       return StringUtil::toString(si->getInt());
@@ -70,6 +78,14 @@ public:
       TestSI* si = static_cast<TestSI*>(target);
       si->setInt(StringUtil::parseInt(handler->getValue()));
     }
+    virtual bool doGetValue(const void* target, ParamValue& value) const {
+      value = ParamValue::makeInt(static_cast<const TestSI*>(target)->getInt());
+      return true;
+    }
+    virtual bool doSetValue(void* target, const ParamValue& value) {
+      static_cast<TestSI*>(target)->setInt(value.getInt());
+      return true;
+    }
   };
 
   static ParamBool msParamBool;
@@ -112,13 +128,43 @@ protected:
     mUi = getImplUi();
     mUi->setLastOutput("");
     mUi->setCmdLine("");
+    mBase = 0;
   }
 
   void TearDown() {
     if (dir0) delete dir0;
+    if (mBase) delete mBase;
     sgConsole.setCwd(&sgRootDir);
   }
 
+  /**
+   * Create dir base under root for tests of many dirs, it's deleted at
+   * TearDown.
+   */
+  AbsDir* createBase() {
+    mBase = new AbsDir("base");
+    sgRootDir.addChild(mBase, false);
+    return mBase;
+  }
+
+  /**
+   * Add n children named prefix0 ... to parent.
+   * @param temp : add them as temp dirs
+   * @param bare : children have no string interface, otherwise they have a
+   * TestSI whose paramInt is their index
+   */
+  void addItems(AbsDir* parent, size_t n, const std::string& prefix = "item",
+      bool temp = false, bool bare = false) {
+    for (size_t i = 0; i < n; ++i) {
+      TestSI* si = 0;
+      if (!bare) {
+        si = new TestSI();
+        si->setInt(static_cast<int>(i));
+      }
+      parent->addChild(new AbsDir(prefix + StringUtil::toString(i), si), temp);
+    }
+  }
+
   ImplConsoleUI* getImplUi() {
     return static_cast<ImplConsoleUI*>(sgConsole.getUi());
   }
@@ -132,6 +178,7 @@ protected:
   std::string pathDir0, pathDir0_0, pathDir0_1, pathDir0_0_0, pathDir0_0_1,
       pathDir0_1_0, pathDir0_1_1, pathConsole;
   ImplConsoleUI* mUi;
+  AbsDir* mBase;
 };
 }
 
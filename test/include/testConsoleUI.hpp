@@ -14,7 +14,7 @@ StringVector getSortedVector(std::initializer_list<std::string> items) {
 
 class ImplConsoleUI : public ConsoleUI {
 public:
-  ImplConsoleUI() : mAlpha(1.0f) {}
+  ImplConsoleUI() : mAlpha(1.0f), mNumOutputs(0), mNumEvicted(0) {}
 
   virtual void setCmdLine(const std::string& cmdLine) { mCmdLine = cmdLine; }
   virtual std::string getCmdLine() { return mCmdLine; }
@@ -30,9 +30,17 @@ public:
   virtual void setVisible(bool v) { (void)v; }
   virtual void setFocus(bool v) { (void)v; }
 
-  virtual void output(const std::string& output, int type = 1) {
-    mLastOutput = output;
+  // record every write, front end might get it later as part of a batch
+  virtual void write(const Fragment* beg, const Fragment* end, int type) {
+    mLastOutput.clear();
+    for (const Fragment* f = beg; f != end; ++f)
+      mLastOutput.append(f->data, f->size);
+    ConsoleUI::write(beg, end, type);
   }
+  virtual void appendOutput(const std::string& output, int type) {
+    ++mNumOutputs;
+  }
+  virtual void evictOutput(size_t numChars) { mNumEvicted += numChars; }
 
   const std::string& getLastOutput() const { return mLastOutput; }
   void setLastOutput(const std::string& v) { mLastOutput = v; }
@@ -58,6 +66,8 @@ public:
   std::string mCwd;
   std::string mLastOutput;
   Real mAlpha;
+  size_t mNumOutputs;
+  size_t mNumEvicted;
 };
 }
 
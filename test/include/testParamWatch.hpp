@@ -0,0 +1,90 @@
+#ifndef TESTPARAMWATCH_H
+#define TESTPARAMWATCH_H
+#include "testConsoleSystem.hpp"
+#include "pacParamWatch.h"
+#include "pacOutputSink.h"
+#include "gtest/gtest.h"
+
+namespace pac {
+
+class UnreadableSI : public TestSI {
+public:
+  virtual std::string getParameter(const std::string& name) const {
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE, "can not read " + name);
+  }
+};
+
+TEST_F(TestConsoleSystem, paramWatch) {
+  QueuedParamListener listener;
+  QueuedParamListener::Events events;
+  ParamWatch::add(dir0, "paramInt", &listener);
+  ParamWatch::add(dir0, "paramInt", &listener);
+
+  dir0->setParameter("paramInt", "3");
+  dir0->setParameter("paramBool", "true");
+  dir0_0->setParameter("paramInt", "4");
+  listener.drain(events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(dir0, events[0].dir);
+  EXPECT_EQ("paramInt", events[0].name);
+  EXPECT_EQ("3", events[0].value);
+
+  // changes behind console's back are only found by sampling
+  TestSI* si = static_cast<TestSI*>(dir0_1->getStringInterface());
+  ParamWatch::add(dir0_1, "paramInt", &listener, true);
+  si->setInt(7);
+  EXPECT_EQ(0, listener.getNumQueued());
+  EXPECT_EQ(1, ParamWatch::sample());
+  EXPECT_EQ(0, ParamWatch::sample());
+  dir0_1->setParameter("paramInt", "8");
+  EXPECT_EQ(0, ParamWatch::sample());
+  listener.drain(events);
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("7", events[0].value);
+  EXPECT_EQ("8", events[1].value);
+
+  EXPECT_TRUE(ParamWatch::remove(dir0, "paramInt", &listener));
+  EXPECT_FALSE(ParamWatch::remove(dir0, "paramInt", &listener));
+  dir0->setParameter("paramInt", "5");
+  EXPECT_EQ(0, listener.getNumQueued());
+
+  // watches die with dir
+  delete dir0_1;
+  EXPECT_FALSE(ParamWatch::hasWatches());
+  EXPECT_EQ(0, ParamWatch::sample());
+
+  ParamWatch::add(dir0_0, "paramInt", &listener, true);
+  ParamWatch::removeListener(&listener);
+  EXPECT_FALSE(ParamWatch::hasWatches());
+
+  // failed sampled watch leaves nothing behind
+  AbsDir* unreadable = new AbsDir("unreadable", new UnreadableSI());
+  EXPECT_THROW(ParamWatch::add(unreadable, "paramInt", &listener, true),
+      InvalidStateException);
+  EXPECT_FALSE(ParamWatch::hasWatches());
+  delete unreadable;
+}
+
+TEST_F(TestConsoleSystem, executeCmdWatch) {
+  CaptureSink capture;
+  sgConsole.addSink(&capture);
+  sgConsole.execute("watch " + pathDir0 + " paramInt");
+  sgConsole.execute("set " + pathDir0 + " paramInt 9");
+  sgConsole.removeSink(&capture);
+  EXPECT_NE(std::string::npos,
+      capture.getCaptured().find(pathDir0 + " : paramInt : 9"));
+
+  capture.clear();
+  sgConsole.addSink(&capture);
+  sgConsole.execute("watch");
+  sgConsole.execute("watch -d " + pathDir0 + " paramInt");
+  sgConsole.execute("set " + pathDir0 + " paramInt 10");
+  sgConsole.removeSink(&capture);
+  EXPECT_NE(std::string::npos,
+      capture.getCaptured().find(pathDir0 + " : paramInt : false"));
+  EXPECT_EQ(std::string::npos, capture.getCaptured().find(" : paramInt : 10"));
+  EXPECT_FALSE(ParamWatch::hasWatches());
+}
+}
+
+#endif /* TESTPARAMWATCH_H */
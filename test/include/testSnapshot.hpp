@@ -0,0 +1,210 @@
+#ifndef TESTSNAPSHOT_H
+#define TESTSNAPSHOT_H
+#include "testConsoleSystem.hpp"
+#include "pacSnapshot.h"
+#include "pacException.h"
+#include "pacStdUtil.h"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include "gtest/gtest.h"
+
+namespace pac {
+
+TEST_F(TestConsoleSystem, serializeText) {
+  dir0_0->setParameter("paramInt", "5");
+  dir0_0->setParameter("paramBool", "true");
+  dir0_0->setParameter("paramString", "two");
+  std::stringstream ss;
+  dir0_0->serialize(ss, false, 1);
+  EXPECT_EQ(
+      "  dir0_0\n"
+      "    paramBool true\n"
+      "    paramInt 5\n"
+      "    paramString two\n",
+      ss.str());
+}
+
+TEST_F(TestConsoleSystem, snapshotRoundTrip) {
+  dir0->setParameter("paramInt", "1");
+  dir0_1_0->setParameter("paramString", "three");
+  dir0_1_0->setParameter("paramBool", "true");
+  dir0_0_1->setParameter("paramInt", "-7");
+  sgConsole.execute("sz -b test_snapshot.bin " + pathDir0);
+
+  dir0->setParameter("paramInt", "2");
+  dir0_1_0->setParameter("paramString", "one");
+  dir0_1_0->setParameter("paramBool", "false");
+  dir0_0_1->setParameter("paramInt", "0");
+  // only valid strings are applied
+  sgConsole.execute("load test_snapshot.bin " + pathDir0);
+  EXPECT_EQ("1", dir0->getParameter("paramInt"));
+  EXPECT_EQ("three", dir0_1_0->getParameter("paramString"));
+  EXPECT_EQ("true", dir0_1_0->getParameter("paramBool"));
+  EXPECT_EQ("-7", dir0_0_1->getParameter("paramInt"));
+
+  // missing dirs are skipped, blank paramString is rejected
+  delete dir0_1;
+  EXPECT_EQ(4 * 2, Snapshot::load(dir0, "test_snapshot.bin"));
+  std::remove("test_snapshot.bin");
+
+  std::string buf;
+  Snapshot::write(dir0, buf);
+  EXPECT_THROW(Snapshot::apply(dir0, buf.data(), buf.size() - 1),
+      InvalidParametersException);
+  buf[4] = 2;
+  EXPECT_THROW(Snapshot::apply(dir0, buf.data(), buf.size()),
+      InvalidParametersException);
+}
+
+TEST_F(TestConsoleSystem, snapshotIncrement) {
+  dir0->setParameter("paramInt", "1");
+  dir0_1_0->setParameter("paramString", "two");
+  std::string base;
+  Snapshot::write(dir0, base);
+  size_t baseGeneration = Snapshot::getGeneration(base.data(), base.size());
+  EXPECT_EQ(StringInterface::getChangeGeneration(), baseGeneration);
+  EXPECT_EQ(Snapshot::getSessionId(),
+      Snapshot::getSession(base.data(), base.size()));
+
+  dir0_0_1->setParameter("paramInt", "5");
+  dir0_1_0->setParameter("paramString", "three");
+  EXPECT_LT(baseGeneration, dir0_1_0->getChangeGeneration());
+  EXPECT_EQ(0, dir0_1_0->getStringInterface()->getParamGeneration("paramBool"));
+  std::string increment;
+  Snapshot::writeIncrement(dir0, increment, baseGeneration);
+  // unchanged dirs and params are not written
+  EXPECT_EQ(std::string::npos, increment.find("dir0_1_1"));
+  EXPECT_EQ(std::string::npos, increment.find("paramBool"));
+
+  dir0_0_1->setParameter("paramInt", "0");
+  dir0_1_0->setParameter("paramString", "one");
+  EXPECT_EQ(2, Snapshot::apply(dir0, increment.data(), increment.size()));
+  EXPECT_EQ("5", dir0_0_1->getParameter("paramInt"));
+  EXPECT_EQ("three", dir0_1_0->getParameter("paramString"));
+
+  // nothing changed since then
+  std::string empty;
+  Snapshot::writeIncrement(dir0, empty, StringInterface::getChangeGeneration());
+  EXPECT_EQ(0, Snapshot::apply(dir0, empty.data(), empty.size()));
+
+  StringVector snapshots = {base, increment};
+  std::string merged;
+  Snapshot::merge(snapshots, merged);
+  EXPECT_EQ(Snapshot::getGeneration(increment.data(), increment.size()),
+      Snapshot::getGeneration(merged.data(), merged.size()));
+  dir0->setParameter("paramInt", "2");
+  dir0_0_1->setParameter("paramInt", "0");
+  dir0_1_0->setParameter("paramString", "one");
+  Snapshot::apply(dir0, merged.data(), merged.size());
+  EXPECT_EQ("1", dir0->getParameter("paramInt"));
+  EXPECT_EQ("5", dir0_0_1->getParameter("paramInt"));
+  EXPECT_EQ("three", dir0_1_0->getParameter("paramString"));
+
+  // corrupt count is rejected before anything is allocated for it
+  size_t countPos = 24 + 4 + dir0->getName().size();
+  snapshots[0].replace(countPos, 4, "\xff\xff\xff\xff");
+  EXPECT_THROW(Snapshot::merge(snapshots, merged), InvalidParametersException);
+}
+
+TEST_F(TestConsoleSystem, executeCmdSzIncrement) {
+  dir0_1_0->setParameter("paramInt", "3");
+  sgConsole.execute("sz -b test_base.bin " + pathDir0);
+  dir0_1_0->setParameter("paramInt", "4");
+  sgConsole.execute("sz test_inc.bin " + pathDir0 + " since test_base.bin");
+  sgConsole.execute("szmerge test_merged.bin test_base.bin test_inc.bin");
+
+  dir0_1_0->setParameter("paramInt", "0");
+  EXPECT_EQ(1, Snapshot::load(dir0, "test_inc.bin"));
+  EXPECT_EQ("4", dir0_1_0->getParameter("paramInt"));
+  dir0_1_0->setParameter("paramInt", "0");
+  Snapshot::load(dir0, "test_merged.bin");
+  EXPECT_EQ("4", dir0_1_0->getParameter("paramInt"));
+
+  // base of another session falls back to full snapshot
+  std::string base = Snapshot::read("test_base.bin");
+  base[8] = ~base[8];
+  std::ofstream("test_base.bin", std::ios::binary).write(
+      base.data(), base.size());
+  EXPECT_FALSE(Snapshot::saveSince(dir0, "test_inc.bin", base));
+  dir0_1_0->setParameter("paramInt", "0");
+  EXPECT_LT(1, Snapshot::load(dir0, "test_inc.bin"));
+  EXPECT_EQ("4", dir0_1_0->getParameter("paramInt"));
+  sgConsole.execute("sz test_inc.bin " + pathDir0 + " since test_base.bin");
+  EXPECT_LT(1, Snapshot::load(dir0, "test_inc.bin"));
+  std::remove("test_base.bin");
+  std::remove("test_inc.bin");
+  std::remove("test_merged.bin");
+}
+
+TEST_F(TestConsoleSystem, snapshotManyParams) {
+  AbsDir* base = createBase();
+  addItems(base, 1000);
+  for (size_t i = 0; i < base->getNumChildren(); ++i)
+    static_cast<TestSI*>(base->getChildAt(i)->getStringInterface())
+        ->setString("one");
+
+  Snapshot::save(base, "test_snapshot.bin");
+  static_cast<TestSI*>(base->getChildAt(123)->getStringInterface())->setInt(0);
+  EXPECT_EQ(3000, Snapshot::load(base, "test_snapshot.bin"));
+  std::remove("test_snapshot.bin");
+  EXPECT_EQ("123", base->getChildAt(123)->getParameter("paramInt"));
+}
+
+TEST_F(TestConsoleSystem, parallelSerialize) {
+  AbsDir* base = createBase();
+  addItems(base, 50, "child");
+  for (size_t i = 0; i < base->getNumChildren(); ++i)
+    addItems(base->getChildAt(i), 100, "leaf");
+
+  StdUtil::setMaxThreads(1);
+  std::stringstream sequential;
+  base->serialize(sequential);
+  std::string sequentialSnapshot;
+  Snapshot::write(base, sequentialSnapshot);
+
+  StdUtil::setMaxThreads(8);
+  std::stringstream parallel;
+  base->serialize(parallel);
+  std::string parallelSnapshot;
+  Snapshot::write(base, parallelSnapshot);
+  StdUtil::setMaxThreads(0);
+
+  const std::string& text = sequential.str();
+  EXPECT_EQ(text, parallel.str());
+  EXPECT_EQ(sequentialSnapshot, parallelSnapshot);
+  EXPECT_EQ(0, text.find("base\n  child0\n    paramBool"));
+  // a line for each dir and each param, base has no param
+  EXPECT_EQ(5051 + 5050 * 3, std::count(text.begin(), text.end(), '\n'));
+}
+
+class ThrowingSI : public TestSI {
+public:
+  virtual void serialize(std::ostream& os, size_t lvl = 0) {
+    PAC_EXCEPT(Exception::ERR_INVALID_STATE, "failed to serialize");
+  }
+};
+
+TEST_F(TestConsoleSystem, parallelSerializeThrow) {
+  AbsDir* base = createBase();
+  addItems(base, 5000, "leaf");
+  base->addChild(new AbsDir("throwing", new ThrowingSI()), false);
+
+  // exception of a worker reaches calling thread
+  StdUtil::setMaxThreads(8);
+  std::stringstream ss;
+  EXPECT_THROW(base->serialize(ss), InvalidStateException);
+  std::vector<int> done(64, 0);
+  EXPECT_THROW(StdUtil::parallelChunks(64, 64,
+                   [&](size_t chunk, size_t first, size_t last) -> void {
+                     done[chunk] = 1;
+                     if (chunk % 2) PAC_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                         "chunk " + StringUtil::toString(chunk));
+                   }),
+      InvalidParametersException);
+  EXPECT_EQ(64, std::count(done.begin(), done.end(), 1));
+  StdUtil::setMaxThreads(0);
+}
+}
+
+#endif /* TESTSNAPSHOT_H */
@@ -72,4 +72,34 @@ TEST(StringUtil_getTail, absolute2Delim) {
       StringUtil::getTail(pac::delim + "abcd" + pac::delim + "efg").c_str());
 }
 
+TEST(StringUtil_match, trailingWildcard) {
+  EXPECT_TRUE(StringUtil::match("abc", "abc*"));
+  EXPECT_TRUE(StringUtil::match("abcd", "abc*"));
+  EXPECT_TRUE(StringUtil::match("abc", "abc**"));
+  EXPECT_FALSE(StringUtil::match("ab", "abc*"));
+}
+
+TEST(StringUtil_match, wildcardOnly) {
+  EXPECT_TRUE(StringUtil::match("", "*"));
+  EXPECT_TRUE(StringUtil::match("abc", "*"));
+  EXPECT_FALSE(StringUtil::match("", "a*"));
+}
+
+TEST(StringUtil_match, innerWildcard) {
+  EXPECT_TRUE(StringUtil::match("ac", "a*c"));
+  EXPECT_TRUE(StringUtil::match("abc", "a*c"));
+  EXPECT_TRUE(StringUtil::match("abcbc", "a*c"));
+  EXPECT_FALSE(StringUtil::match("ab", "a*c"));
+  EXPECT_FALSE(StringUtil::match("abcd", "a*c"));
+  EXPECT_TRUE(StringUtil::match("ABC", "a*c", false));
+  EXPECT_FALSE(StringUtil::match("ABC", "a*c"));
+}
+
+TEST(StringUtil_appendJsonString, escape) {
+  std::string s("x");
+  std::string v("a\"b\\c\nd\x01");
+  StringUtil::appendJsonString(s, v.data(), v.size());
+  ASSERT_EQ("x\"a\\\"b\\\\c\\nd\\u0001\"", s);
+}
+
 #endif  // TESTPACSTRINGUTIL_H
@@ -7,6 +7,9 @@
 #include "testConsole.hpp"
 #include "testConsolePattern.hpp"
 #include "testCmdHistory.hpp"
+#include "testCmdStats.hpp"
+#include "testParamWatch.hpp"
+#include "testSnapshot.hpp"
 #include "testStdUtil.hpp"
 #include "testStringUtil.hpp"
 using namespace pac;